@@ -36,6 +36,27 @@ const Vec2& Animation::getSize() const {
 	return m_size;
 }
 
+size_t Animation::getCurrentFrame() const {
+	return m_currentFrame;
+}
+
+size_t Animation::getFrameCount() const {
+	return m_frameCount;
+}
+
+size_t Animation::getSpeed() const {
+	return m_speed;
+}
+
+//jumps straight to a frame, used when restoring saved state
+void Animation::setCurrentFrame(size_t frame)
+{
+	m_currentFrame = frame;
+	if (m_frameCount <= 1) return;
+	size_t f = m_currentFrame / m_speed % m_frameCount;
+	m_sprite.setTextureRect(sf::IntRect((int) f * m_size.x, 0, (int)m_size.x, (int) m_size.y));
+}
+
 const std::string& Animation::getName() const {
 	return m_name;
 }
@@ -44,6 +65,10 @@ sf::Sprite& Animation::getSprite(){
 	return m_sprite;
 }
 
+const sf::Sprite& Animation::getSprite() const {
+	return m_sprite;
+}
+
 bool Animation::hasEnded() const {
 	return m_currentFrame >= m_frameCount * m_speed;
 }
\ No newline at end of file
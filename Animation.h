@@ -22,5 +22,10 @@ public:
 	bool hasEnded() const;
 	const std::string& getName() const;
 	const Vec2& getSize() const;
+	size_t getCurrentFrame() const;
+	size_t getFrameCount() const;
+	size_t getSpeed() const;
+	void setCurrentFrame(size_t frame);
 	sf::Sprite& getSprite(); //recheck
+	const sf::Sprite& getSprite() const;
 };
\ No newline at end of file
@@ -4,6 +4,8 @@ Assets::Assets(){}
 
 void Assets::loadFromFile(const std::string& path) 
 {
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+
 	std::ifstream file(path);
 	std::string str;
 	while (file >> str)
@@ -12,80 +14,396 @@ void Assets::loadFromFile(const std::string& path)
 		{
 			std::string name, path;
 			file >> name >> path;
-			addTexture(name, path);
+			m_texturePaths[name] = path;
 		}
 		else if (str == "Animation")
 		{
 			std::string name, texture;
 			size_t frames, speed;
 			file >> name >> texture >> frames >> speed;
-			addAnimation(name, texture, frames, speed);
+			m_animationSources[name] = { texture, frames, speed };
 		}
 		else if (str == "Font")
 		{
 			std::string name, path;
 			file >> name >> path;
-			addFont(name, path);
+			m_fontPaths[name] = path;
+		}
+		else if (str == "Sound")
+		{
+			std::string name, path;
+			file >> name >> path;
+			addSound(name, path);
+		}
+		else if (str == "Music")
+		{
+			std::string name, path;
+			file >> name >> path;
+			addMusic(name, path);
 		}
 		else
 		{
 			std::cerr << "Unknown asset type: " << str << "\n";
 		}
 	}
+
+	//asset files from before Music entries keep the tracks the scenes used to open directly
+	static const std::pair<const char*, const char*> defaultMusic[] = { { "Level", "bin/audio/level.flac" }, { "Menu", "bin/audio/menu.flac" } };
+	for (auto& music : defaultMusic)
+	{
+		if (m_musicMap.count(music.first)) continue;
+		std::cerr << "No Music " << music.first << " entry in " << path << ", using " << music.second << "\n";
+		addMusic(music.first, music.second);
+	}
 }
 
-void Assets::addTexture(const std::string& textureName, const std::string& path, bool smooth) 
+//re-reads the manifest and only touches entries that are new or differ from what is loaded,
+//anything not loaded right now just has its declaration updated
+void Assets::reloadFromFile(const std::string& path, std::set<std::string>& changedAnimations)
 {
-	m_textureMap[textureName] = sf::Texture();
-	
-	if (!m_textureMap[textureName].loadFromFile(path))
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+
+	std::ifstream file(path);
+	std::string str;
+	while (file >> str)
 	{
-		std::cerr << "Couldn't load texture file: " << path << "\n";
+		if (str == "Texture")
+		{
+			std::string name, path;
+			file >> name >> path;
+			if (m_texturePaths.count(name) && m_texturePaths[name] == path) continue;
+			m_texturePaths[name] = path;
+			if (m_textureRefs.count(name)) swapTexture(name, changedAnimations);
+		}
+		else if (str == "Animation")
+		{
+			std::string name, texture;
+			size_t frames, speed;
+			file >> name >> texture >> frames >> speed;
+			auto source = m_animationSources.find(name);
+			if (source != m_animationSources.end() && source->second.texture == texture
+				&& source->second.frameCount == frames && source->second.speed == speed) continue;
+			setAnimationSource(name, { texture, frames, speed }, changedAnimations);
+		}
+		else if (str == "Font" || str == "Sound" || str == "Music")
+		{
+			std::string name, path;
+			file >> name >> path;
+			if (str == "Font" && !m_fontPaths.count(name)) m_fontPaths[name] = path;
+			if (str == "Sound" && !m_soundMap.count(name)) addSound(name, path);
+			if (str == "Music") addMusic(name, path);
+		}
+		else
+		{
+			std::cerr << "Unknown asset type: " << str << "\n";
+		}
+	}
+}
+
+bool Assets::reloadTexture(const std::string& textureName, std::set<std::string>& changedAnimations)
+{
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	if (!m_textureRefs.count(textureName)) return false;
+	return swapTexture(textureName, changedAnimations);
+}
+
+//loads the new image into the existing texture object so every sprite pointing at it stays valid,
+//then rebuilds the animations cut from it in case the image size changed
+bool Assets::swapTexture(const std::string& textureName, std::set<std::string>& changedAnimations)
+{
+	assert(m_texturePaths.find(textureName) != m_texturePaths.end());
+
+	sf::Texture texture;
+	if (!texture.loadFromFile(m_texturePaths.at(textureName)))
+	{
+		std::cerr << "Couldn't reload texture file: " << m_texturePaths.at(textureName) << "\n";
+		return false;
+	}
+	texture.setSmooth(true);
+	m_textureMap[textureName].swap(texture);
+	std::cout << "reloaded texture : " << m_texturePaths.at(textureName) << "\n";
+
+	for (auto& a : m_animationSources)
+	{
+		if (a.second.texture != textureName || !m_animationRefs.count(a.first)) continue;
+		m_animationMap[a.first] = std::make_shared<const Animation>(a.first, m_textureMap[textureName], a.second.frameCount, a.second.speed);
+		changedAnimations.insert(a.first);
+	}
+	return true;
+}
+
+//a loaded animation that moved to another texture takes a reference on the new one before letting go of the old
+void Assets::setAnimationSource(const std::string& animationName, const AnimationSource& source, std::set<std::string>& changedAnimations)
+{
+	auto old = m_animationSources.find(animationName);
+	if (old == m_animationSources.end() || !m_animationRefs.count(animationName))
+	{
+		m_animationSources[animationName] = source;
+		return;
+	}
+
+	if (old->second.texture != source.texture)
+	{
+		if (!acquireTexture(source.texture)) return;
+		releaseTexture(old->second.texture);
+	}
+
+	m_animationSources[animationName] = source;
+	m_animationMap[animationName] = std::make_shared<const Animation>(animationName, m_textureMap.at(source.texture), source.frameCount, source.speed);
+	changedAnimations.insert(animationName);
+}
+
+void Assets::acquire(const Manifest& manifest) const
+{
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	for (auto& name : manifest.animations) acquireAnimation(name);
+	for (auto& name : manifest.fonts) acquireFont(name);
+}
+
+//whatever drops to zero holders is freed right away, the scene letting go is already gone so nothing still draws it
+void Assets::release(const Manifest& manifest) const
+{
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	for (auto& name : manifest.animations) releaseAnimation(name);
+	for (auto& name : manifest.fonts) releaseFont(name);
+}
+
+bool Assets::acquireTexture(const std::string& textureName) const
+{
+	auto path = m_texturePaths.find(textureName);
+	if (path == m_texturePaths.end())
+	{
+		std::cerr << "Unknown texture: " << textureName << "\n";
+		return false;
+	}
+	if (m_textureRefs[textureName]++ > 0) return true;
+
+	if (!m_textureMap[textureName].loadFromFile(path->second))
+	{
+		std::cerr << "Couldn't load texture file: " << path->second << "\n";
 		m_textureMap.erase(textureName);
+		m_textureRefs.erase(textureName);
+		return false;
 	}
-	else
+	m_textureMap[textureName].setSmooth(true);
+	std::cout << "loaded texture : " << path->second << "\n";
+	return true;
+}
+
+void Assets::releaseTexture(const std::string& textureName) const
+{
+	auto refs = m_textureRefs.find(textureName);
+	if (refs == m_textureRefs.end() || --refs->second > 0) return;
+
+	m_textureRefs.erase(refs);
+	m_textureMap.erase(textureName);
+	std::cout << "evicted texture : " << m_texturePaths.at(textureName) << "\n";
+}
+
+bool Assets::acquireAnimation(const std::string& animationName) const
+{
+	auto source = m_animationSources.find(animationName);
+	if (source == m_animationSources.end())
+	{
+		std::cerr << "Unknown animation: " << animationName << "\n";
+		return false;
+	}
+	if (m_animationRefs[animationName]++ > 0) return true;
+
+	if (!acquireTexture(source->second.texture))
+	{
+		m_animationRefs.erase(animationName);
+		return false;
+	}
+	m_animationMap[animationName] = std::make_shared<const Animation>(animationName, m_textureMap.at(source->second.texture), source->second.frameCount, source->second.speed);
+	return true;
+}
+
+void Assets::releaseAnimation(const std::string& animationName) const
+{
+	auto refs = m_animationRefs.find(animationName);
+	if (refs == m_animationRefs.end() || --refs->second > 0) return;
+
+	m_animationRefs.erase(refs);
+	m_animationMap.erase(animationName);
+	releaseTexture(m_animationSources.at(animationName).texture);
+}
+
+bool Assets::acquireFont(const std::string& fontName) const
+{
+	auto path = m_fontPaths.find(fontName);
+	if (path == m_fontPaths.end())
+	{
+		std::cerr << "Unknown font: " << fontName << "\n";
+		return false;
+	}
+	if (m_fontRefs[fontName]++ > 0) return true;
+
+	auto font = std::make_shared<sf::Font>();
+	if (!font->loadFromFile(path->second))
 	{
-		m_textureMap[textureName].setSmooth(smooth);
-		std::cout << "loaded texture : " << path << "\n";
+		std::cerr << "Couldn't load font file: " << path->second << "\n";
+		m_fontRefs.erase(fontName);
+		return false;
 	}
+	m_fontMap[fontName] = font;
+	std::cout << "loaded font : " << path->second << "\n";
+	return true;
+}
+
+void Assets::releaseFont(const std::string& fontName) const
+{
+	auto refs = m_fontRefs.find(fontName);
+	if (refs == m_fontRefs.end() || --refs->second > 0) return;
+
+	m_fontRefs.erase(refs);
+	m_fontMap.erase(fontName);
+	std::cout << "evicted font : " << m_fontPaths.at(fontName) << "\n";
 }
 
 const sf::Texture& Assets::getTexture(const std::string& textureName) const 
 {
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		auto it = m_textureMap.find(textureName);
+		if (it != m_textureMap.end()) return it->second;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	if (!m_textureMap.count(textureName))
+	{
+		std::cerr << "Texture used without being acquired: " << textureName << "\n";
+		acquireTexture(textureName);
+	}
 	assert(m_textureMap.find(textureName) != m_textureMap.end());
 	return m_textureMap.at(textureName);
 }
 
-//sus
-void Assets::addAnimation(const std::string& animationName, const std::string& textureName, size_t frameCount, size_t speed)
+const Animation& Assets::getAnimation(const std::string& animationName) const 
 {
-	m_animationMap[animationName] = Animation(animationName, getTexture(textureName), frameCount, speed);
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		auto it = m_animationMap.find(animationName);
+		if (it != m_animationMap.end()) return *it->second;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	if (!m_animationMap.count(animationName))
+	{
+		std::cerr << "Animation used without being acquired: " << animationName << "\n";
+		acquireAnimation(animationName);
+	}
+	assert(m_animationMap.find(animationName) != m_animationMap.end());
+	return *m_animationMap.at(animationName);
 }
 
-const Animation& Assets::getAnimation(const std::string& animationName) const 
+const sf::Font& Assets::getFont(const std::string& fontName) const 
 {
-	assert(m_animationMap.find(animationName) != m_animationMap.end());
-	return m_animationMap.at(animationName);
+	{
+		std::shared_lock<std::shared_mutex> lock(m_mutex);
+		auto it = m_fontMap.find(fontName);
+		if (it != m_fontMap.end()) return *it->second;
+	}
+
+	std::unique_lock<std::shared_mutex> lock(m_mutex);
+	if (!m_fontMap.count(fontName))
+	{
+		std::cerr << "Font used without being acquired: " << fontName << "\n";
+		acquireFont(fontName);
+	}
+	assert(m_fontMap.find(fontName) != m_fontMap.end());
+	return *m_fontMap.at(fontName);
+}
+
+std::shared_ptr<const Animation> Assets::animationHandle(const std::string& animationName) const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	auto it = m_animationMap.find(animationName);
+	return it != m_animationMap.end() ? it->second : nullptr;
 }
 
-//sus
-void Assets::addFont(const std::string& fontName, const std::string& path) 
+std::shared_ptr<const sf::Font> Assets::fontHandle(const std::string& fontName) const
 {
-	m_fontMap[fontName] = sf::Font();
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	auto it = m_fontMap.find(fontName);
+	return it != m_fontMap.end() ? it->second : nullptr;
+}
+
+//sound effects are decoded up front so playing one never touches the disk
+void Assets::addSound(const std::string& soundName, const std::string& path)
+{
+	m_soundMap[soundName] = sf::SoundBuffer();
 
-	if (!m_fontMap[fontName].loadFromFile(path))
+	if (!m_soundMap[soundName].loadFromFile(path))
 	{
-		std::cerr << "Couldn't load font file: " << path << "\n";
-		m_textureMap.erase(fontName);
+		std::cerr << "Couldn't load sound file: " << path << "\n";
+		m_soundMap.erase(soundName);
 	}
 	else
 	{
-		std::cout << "loaded font : " << path << "\n";
+		std::cout << "loaded sound : " << path << "\n";
 	}
 }
 
-const sf::Font& Assets::getFont(const std::string& fontName) const 
+const sf::SoundBuffer& Assets::getSound(const std::string& soundName) const
 {
-	assert(m_fontMap.find(fontName) != m_fontMap.end());
-	return m_fontMap.at(fontName);
+	assert(m_soundMap.find(soundName) != m_soundMap.end());
+	return m_soundMap.at(soundName);
+}
+
+bool Assets::hasSound(const std::string& soundName) const
+{
+	return m_soundMap.find(soundName) != m_soundMap.end();
+}
+
+void Assets::addMusic(const std::string& musicName, const std::string& path)
+{
+	m_musicMap[musicName] = path;
+}
+
+const std::string& Assets::getMusicPath(const std::string& musicName) const
+{
+	assert(m_musicMap.find(musicName) != m_musicMap.end());
+	return m_musicMap.at(musicName);
+}
+
+bool Assets::hasMusic(const std::string& musicName) const
+{
+	return m_musicMap.find(musicName) != m_musicMap.end();
+}
+
+Vec2 Assets::animationSize(const std::string& animationName) const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	auto it = m_animationMap.find(animationName);
+	return it != m_animationMap.end() ? it->second->getSize() : Vec2(0, 0);
+}
+
+Assets::MemoryUsage Assets::memoryUsage() const
+{
+	std::shared_lock<std::shared_mutex> lock(m_mutex);
+	MemoryUsage usage;
+
+	usage.textures.count = m_textureMap.size();
+	for (auto& t : m_textureMap)
+	{
+		usage.textures.bytes += sizeof(t) + t.first.capacity();
+		usage.textureGpuBytes += (size_t)t.second.getSize().x * t.second.getSize().y * 4;
+	}
+
+	usage.animations.count = m_animationMap.size();
+	for (auto& a : m_animationMap) usage.animations.bytes += sizeof(a) + sizeof(Animation) + a.first.capacity();
+
+	usage.fonts.count = m_fontMap.size();
+	for (auto& f : m_fontMap) usage.fonts.bytes += sizeof(f) + sizeof(sf::Font) + f.first.capacity();
+
+	usage.sounds.count = m_soundMap.size();
+	for (auto& s : m_soundMap) usage.sounds.bytes += sizeof(s) + s.first.capacity() + (size_t)s.second.getSampleCount() * sizeof(sf::Int16);
+
+	return usage;
+}
+
+const std::map<std::string, std::string>& Assets::getTexturePaths() const
+{
+	return m_texturePaths;
 }
\ No newline at end of file
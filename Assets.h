@@ -2,26 +2,107 @@
 
 #include"Animation.h"
 
+#include<SFML/Audio.hpp>
+
 #include<cassert>
 #include<iostream>
 #include<fstream>
+#include<set>
+#include<memory>
+#include<mutex>
+#include<shared_mutex>
 
+//the asset file only declares what exists, textures, animations and fonts are read from disk the first time
+//a scene acquires them and dropped again once no scene holds them, so startup doesn't pay for every level
+//sounds are small and played from anywhere, they are still decoded up front
 class Assets
 {
-	std::map<std::string, sf::Texture> m_textureMap;
-	std::map<std::string, Animation> m_animationMap;
-	std::map<std::string, sf::Font> m_fontMap;
+public:
+
+	//animations and fonts a scene holds on to for as long as it exists
+	struct Manifest
+	{
+		std::set<std::string> animations;
+		std::set<std::string> fonts;
+	};
+
+	//what is loaded right now and roughly what it costs
+	struct Usage
+	{
+		size_t count = 0;
+		size_t bytes = 0;
+	};
+
+	struct MemoryUsage
+	{
+		Usage textures, animations, fonts, sounds;
+		size_t textureGpuBytes = 0;
+	};
+
+private:
+
+	//what an animation was built from, so it can be rebuilt when its texture changes
+	struct AnimationSource
+	{
+		std::string texture;
+		size_t frameCount, speed;
+	};
+
+	//loaded on demand from behind const lookups, the mutex is shared by lookups and taken alone to load or evict
+	//a reload puts a new animation in the map rather than changing the old one, so a handle never changes under a reader
+	mutable std::map<std::string, sf::Texture> m_textureMap;
+	mutable std::map<std::string, std::shared_ptr<const Animation>> m_animationMap;
+	mutable std::map<std::string, std::shared_ptr<const sf::Font>> m_fontMap;
+	mutable std::map<std::string, size_t> m_textureRefs;	//animations using the texture
+	mutable std::map<std::string, size_t> m_animationRefs;	//scenes holding the animation
+	mutable std::map<std::string, size_t> m_fontRefs;
+	mutable std::shared_mutex m_mutex;
 
-	void addTexture(const std::string& textureName, const std::string& path, bool smooth = true);
-	void addAnimation(const std::string& animationName, const std::string& textureName, size_t frameCount, size_t speed);
-	void addFont(const std::string& fontName, const std::string& path);
+	std::map<std::string, sf::SoundBuffer> m_soundMap;
+	std::map<std::string, std::string> m_musicMap; //music is streamed, so only the path is kept
+	std::map<std::string, std::string> m_texturePaths;
+	std::map<std::string, AnimationSource> m_animationSources;
+	std::map<std::string, std::string> m_fontPaths;
+
+	void addSound(const std::string& soundName, const std::string& path);
+	void addMusic(const std::string& musicName, const std::string& path);
+
+	bool acquireTexture(const std::string& textureName) const;
+	void releaseTexture(const std::string& textureName) const;
+	bool acquireAnimation(const std::string& animationName) const;
+	void releaseAnimation(const std::string& animationName) const;
+	bool acquireFont(const std::string& fontName) const;
+	void releaseFont(const std::string& fontName) const;
+	void setAnimationSource(const std::string& animationName, const AnimationSource& source, std::set<std::string>& changedAnimations);
+	bool swapTexture(const std::string& textureName, std::set<std::string>& changedAnimations);
 
 public:
 
 	Assets();
 	void loadFromFile(const std::string& path);
+	void reloadFromFile(const std::string& path, std::set<std::string>& changedAnimations);
+	bool reloadTexture(const std::string& textureName, std::set<std::string>& changedAnimations);
 
+	void acquire(const Manifest& manifest) const;
+	void release(const Manifest& manifest) const;
+
+	//anything looked up without being acquired first is loaded on the spot and kept until exit
 	const sf::Texture& getTexture(const std::string& textureName) const;
 	const Animation& getAnimation(const std::string& animationName) const;
 	const sf::Font& getFont(const std::string& fontName) const;
+
+	//what is loaded under a name right now, null if it isn't, stays valid after the name is reloaded or evicted
+	std::shared_ptr<const Animation> animationHandle(const std::string& animationName) const;
+	std::shared_ptr<const sf::Font> fontHandle(const std::string& fontName) const;
+	const sf::SoundBuffer& getSound(const std::string& soundName) const;
+	const std::string& getMusicPath(const std::string& musicName) const;
+
+	bool hasSound(const std::string& soundName) const;
+	bool hasMusic(const std::string& musicName) const;
+
+	//safe while other threads load and evict, unlike walking the maps
+	Vec2 animationSize(const std::string& animationName) const;	//zero if it isn't loaded
+	MemoryUsage memoryUsage() const;
+
+	const std::map<std::string, std::string>& getTexturePaths() const;
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "Audio.h"
+
+#include<algorithm>
+#include<fstream>
+#include<iterator>
+
+//runs on a worker thread so the main loop never waits on the disk
+static std::vector<char> readFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		std::cerr << "Couldn't open music file: " << path << "\n";
+		return {};
+	}
+	return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+Audio::Audio() {}
+
+Audio::Audio(const Assets& assets)
+	:m_assets(&assets) {}
+
+void Audio::update()
+{
+	m_tick++;
+
+	//a future from std::async blocks in its destructor, so superseded reads are only let go once they are done
+	m_superseded.erase(std::remove_if(m_superseded.begin(), m_superseded.end(),
+		[](auto& f) { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }), m_superseded.end());
+
+	//hand the prefetched track over once the worker is done with it and any crossfade still running has finished
+	if (m_fadeFrame >= FADE_FRAMES && m_prefetch.valid() && m_prefetch.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+	{
+		startMusic(m_prefetch.get());
+	}
+
+	updateFade();
+}
+
+//plays an effect from the preloaded bank, stealing the oldest voice if all are busy
+void Audio::playSound(const std::string& soundName)
+{
+	if (!m_assets || !m_assets->hasSound(soundName)) return;
+
+	Voice* voice = &m_voices[0];
+	for (auto& v : m_voices)
+	{
+		if (v.sound.getStatus() != sf::SoundSource::Playing) { voice = &v; break; }
+		if (v.started < voice->started) voice = &v;
+	}
+
+	voice->sound.stop();
+	voice->sound.setBuffer(m_assets->getSound(soundName));
+	voice->sound.play();
+	voice->started = m_tick;
+}
+
+//starts reading the track in the background, the crossfade begins once it has arrived
+void Audio::playMusic(const std::string& musicName)
+{
+	if (!m_assets) return;
+	if (!m_assets->hasMusic(musicName))
+	{
+		std::cerr << "Unknown music: " << musicName << "\n";
+		return;
+	}
+
+	//already playing or already on its way
+	if (m_pendingMusic.empty() && m_decks[m_front].name == musicName) return;
+	if (m_pendingMusic == musicName) return;
+
+	m_pendingMusic = musicName;
+	if (m_prefetch.valid()) m_superseded.push_back(std::move(m_prefetch));
+	m_prefetch = std::async(std::launch::async, readFile, m_assets->getMusicPath(musicName));
+}
+
+void Audio::startMusic(std::vector<char>&& data)
+{
+	std::string name = m_pendingMusic;
+	m_pendingMusic.clear();
+	if (data.empty()) return;
+
+	//the old front deck becomes the one fading out, update only gets here once the back deck has faded out and stopped
+	size_t back = 1 - m_front;
+	auto& deck = m_decks[back];
+	deck.music.stop();
+	deck.data = std::move(data);
+	deck.name = name;
+
+	if (!deck.music.openFromMemory(deck.data.data(), deck.data.size()))
+	{
+		std::cerr << "Couldn't decode music: " << name << "\n";
+		deck.data.clear();
+		deck.name.clear();
+		return;
+	}
+
+	deck.music.setLoop(true);
+	deck.music.setVolume(0.f);
+	deck.music.play();
+
+	m_front = back;
+	m_fadeFrame = 0;
+}
+
+void Audio::updateFade()
+{
+	if (m_fadeFrame >= FADE_FRAMES) return;
+
+	m_fadeFrame++;
+	float t = (float)m_fadeFrame / FADE_FRAMES;
+
+	auto& in = m_decks[m_front];
+	auto& out = m_decks[1 - m_front];
+	in.music.setVolume(m_musicVolume * t);
+	out.music.setVolume(m_musicVolume * (1.f - t));
+
+	if (m_fadeFrame == FADE_FRAMES)
+	{
+		out.music.stop();
+		out.data.clear();
+		out.data.shrink_to_fit();
+		out.name.clear();
+	}
+}
+
+void Audio::stopAll()
+{
+	for (auto& v : m_voices) v.sound.stop();
+	for (auto& d : m_decks) d.music.stop();
+}
+
+void Audio::setMusicVolume(float volume)
+{
+	m_musicVolume = volume;
+	if (m_fadeFrame >= FADE_FRAMES) m_decks[m_front].music.setVolume(volume);
+}
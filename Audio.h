@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Assets.h"
+
+#include<SFML/Audio.hpp>
+#include<array>
+#include<future>
+#include<vector>
+
+class Audio
+{
+	static const size_t VOICE_COUNT = 16;	//max sound effects playing at once
+	static const size_t FADE_FRAMES = 60;	//length of a music crossfade
+
+	struct Voice
+	{
+		sf::Sound sound;
+		size_t started = 0;	//tick the voice was last triggered, oldest gets stolen
+	};
+
+	//sf::Music streams from the buffer it was opened with, so each deck owns its bytes
+	struct MusicDeck
+	{
+		sf::Music music;
+		std::vector<char> data;
+		std::string name;
+	};
+
+	const Assets* m_assets = nullptr;
+	std::array<Voice, VOICE_COUNT> m_voices;
+	std::array<MusicDeck, 2> m_decks;
+	size_t m_front = 0;		//deck that is fading in / playing
+	size_t m_fadeFrame = FADE_FRAMES;
+	float m_musicVolume = 100.f;
+	size_t m_tick = 0;
+
+	std::string m_pendingMusic;
+	std::future<std::vector<char>> m_prefetch;
+	std::vector<std::future<std::vector<char>>> m_superseded;	//reads nobody wants any more, dropped once they finish
+
+	void startMusic(std::vector<char>&& data);
+	void updateFade();
+
+public:
+
+	Audio();
+	Audio(const Assets& assets);
+
+	void update();
+
+	void playSound(const std::string& soundName);
+	void playMusic(const std::string& musicName);
+	void stopAll();
+
+	void setMusicVolume(float volume);
+};
@@ -0,0 +1,71 @@
+#include "BatchMath.h"
+
+#include<algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BATCHMATH_SSE2
+#include<emmintrin.h>
+#endif
+
+void BatchMath::Bodies::resize(size_t n)
+{
+	px.resize(n);
+	py.resize(n);
+	vx.resize(n);
+	vy.resize(n);
+	gravity.resize(n);
+}
+
+size_t BatchMath::Bodies::size() const
+{
+	return px.size();
+}
+
+void BatchMath::ApplyGravity(float* vy, const float* gravity, size_t n)
+{
+	size_t i = 0;
+#ifdef BATCHMATH_SSE2
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(vy + i, _mm_add_ps(_mm_loadu_ps(vy + i), _mm_loadu_ps(gravity + i)));
+	}
+#endif
+	for (; i < n; i++) vy[i] += gravity[i];
+}
+
+//limits each axis to [-max, max]
+void BatchMath::ClampVelocity(float* vx, float* vy, float maxX, float maxY, size_t n)
+{
+	size_t i = 0;
+#ifdef BATCHMATH_SSE2
+	__m128 hiX = _mm_set1_ps(maxX), loX = _mm_set1_ps(-maxX);
+	__m128 hiY = _mm_set1_ps(maxY), loY = _mm_set1_ps(-maxY);
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(vx + i, _mm_max_ps(_mm_min_ps(_mm_loadu_ps(vx + i), hiX), loX));
+		_mm_storeu_ps(vy + i, _mm_max_ps(_mm_min_ps(_mm_loadu_ps(vy + i), hiY), loY));
+	}
+#endif
+	for (; i < n; i++)
+	{
+		vx[i] = std::max(std::min(vx[i], maxX), -maxX);
+		vy[i] = std::max(std::min(vy[i], maxY), -maxY);
+	}
+}
+
+void BatchMath::Integrate(float* px, float* py, const float* vx, const float* vy, size_t n)
+{
+	size_t i = 0;
+#ifdef BATCHMATH_SSE2
+	for (; i + 4 <= n; i += 4)
+	{
+		_mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_loadu_ps(vx + i)));
+		_mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_loadu_ps(vy + i)));
+	}
+#endif
+	for (; i < n; i++)
+	{
+		px[i] += vx[i];
+		py[i] += vy[i];
+	}
+}
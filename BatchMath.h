@@ -0,0 +1,22 @@
+#pragma once
+
+#include<vector>
+#include<cstddef>
+
+//straight loops over arrays of floats, four lanes at a time where SSE2 is available
+//each kernel does the same float operations as the scalar code so results match bit for bit
+namespace BatchMath
+{
+	//positions and velocities split into one array per axis
+	struct Bodies
+	{
+		std::vector<float> px, py, vx, vy, gravity;
+
+		void resize(size_t n);
+		size_t size() const;
+	};
+
+	void ApplyGravity(float* vy, const float* gravity, size_t n);
+	void ClampVelocity(float* vx, float* vy, float maxX, float maxY, size_t n);
+	void Integrate(float* px, float* py, const float* vx, const float* vy, size_t n);
+};
\ No newline at end of file
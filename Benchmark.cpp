@@ -0,0 +1,188 @@
+#include "Benchmark.h"
+#include "Snapshot.h"
+
+#include<filesystem>
+#include<iomanip>
+#include<map>
+#include<sstream>
+
+static const char* SHIPPED_LEVELS[] = { "bin/level1.txt", "bin/level2.txt", "bin/level3.txt" };
+
+//buttons the script can hold, sent as START/END actions whenever they change
+static const std::pair<uint8_t, const char*> BUTTONS[] =
+{
+	{ Scene_Play::INPUT_JUMP, "JUMP" },
+	{ Scene_Play::INPUT_LEFT, "LEFT" },
+	{ Scene_Play::INPUT_RIGHT, "RIGHT" },
+	{ Scene_Play::INPUT_SHOOT, "SHOOT" }
+};
+
+//mostly runs right with regular jumps and shots, turns back for a second every ten
+static uint8_t scriptedButtons(size_t frame)
+{
+	uint8_t buttons = frame % 600 < 540 ? Scene_Play::INPUT_RIGHT : Scene_Play::INPUT_LEFT;
+	if (frame % 45 < 15) buttons |= Scene_Play::INPUT_JUMP;
+	if (frame % 30 < 2) buttons |= Scene_Play::INPUT_SHOOT;
+	return buttons;
+}
+
+static std::string levelName(const std::string& path)
+{
+	return std::filesystem::path(path).stem().string();
+}
+
+//stress levels reuse level 1's player tuning and ground tile so they only need the shipped assets
+static std::vector<std::pair<std::string, std::string>> writeStressLevels()
+{
+	std::string player = "Player 2 2 48 48 5 -20 20 0.75 Buster";
+	std::string ground = "Brick";
+	for (auto& entry : LevelCompiler::Read(SHIPPED_LEVELS[0]))
+	{
+		std::istringstream fin(entry);
+		std::string entityType, animationName;
+		fin >> entityType >> animationName;
+		if (entityType == "Player") player = entry;
+		if (entityType == "Tile" && ground == "Brick" && animationName != "Question" && animationName != "Pole") ground = animationName;
+	}
+
+	auto dir = std::filesystem::temp_directory_path();
+	std::vector<std::pair<std::string, std::string>> levels;
+
+	//a very long level: two rows of ground, a block row every so often and an enemy every eight cells
+	{
+		auto path = (dir / "stress_long.txt").string();
+		std::ofstream fout(path);
+		fout << player << "\n";
+		for (int x = 0; x < 2000; x++)
+		{
+			fout << "Tile " << ground << " " << x << " 0\n";
+			fout << "Tile " << ground << " " << x << " 1\n";
+			if (x % 16 >= 8 && x % 16 < 12) fout << "Tile " << (x % 2 ? "Brick" : "Question") << " " << x << " 5\n";
+			if (x % 8 == 0 && x > 8) fout << "Enemy Goomba " << x << " 2 -2\n";
+		}
+		levels.push_back({ "stress_long", path });
+	}
+
+	//a short arena packed with enemies that are all awake at once
+	{
+		auto path = (dir / "stress_crowd.txt").string();
+		std::ofstream fout(path);
+		fout << player << "\n";
+		fout << "EnemyType Goomba Chase 400 -12 90 0.75\n";
+		for (int x = 0; x < 40; x++)
+		{
+			fout << "Tile " << ground << " " << x << " 0\n";
+			for (int y = 1; y < 4; y++) { if (x > 6) fout << "Enemy Goomba " << x << " " << y * 2 << " -2\n"; }
+		}
+		fout << "Tile " << ground << " -1 1\n";
+		fout << "Tile " << ground << " 40 1\n";
+		levels.push_back({ "stress_crowd", path });
+	}
+
+	return levels;
+}
+
+static Benchmark::LevelResult runLevel(const Assets& assets, const std::string& name, const std::string& path, size_t frames)
+{
+	Scene_Play world(assets, path);
+	Profiler profiler;
+	world.setProfiler(&profiler);
+
+	uint8_t held = 0;
+	for (size_t frame = 0; frame < frames; frame++)
+	{
+		uint8_t buttons = scriptedButtons(frame);
+		for (auto& button : BUTTONS)
+		{
+			if ((buttons ^ held) & button.first) world.doAction(Action(button.second, (buttons & button.first) ? "START" : "END"));
+		}
+		held = buttons;
+		world.simulate(1);
+	}
+
+	WorldState state;
+	world.captureState(state);
+
+	Benchmark::LevelResult result;
+	result.level = name;
+	result.systems = profiler.summarize();
+	result.hash = Snapshot::Hash(state);
+	return result;
+}
+
+std::vector<Benchmark::LevelResult> Benchmark::Run(const Assets& assets, size_t frames)
+{
+	std::vector<std::pair<std::string, std::string>> levels;
+	for (auto& path : SHIPPED_LEVELS) levels.push_back({ levelName(path), path });
+	for (auto& level : writeStressLevels()) levels.push_back(level);
+
+	std::vector<LevelResult> results;
+	for (auto& level : levels) results.push_back(runLevel(assets, level.first, level.second, frames));
+	return results;
+}
+
+//  <level> hash <hex>
+//  <level> <system> <p50> <p99> <max>		(microseconds)
+bool Benchmark::WriteBaseline(const std::string& path, const std::vector<LevelResult>& results)
+{
+	std::ofstream fout(path);
+	if (!fout)
+	{
+		std::cerr << "Couldn't write benchmark baseline: " << path << "\n";
+		return false;
+	}
+
+	for (auto& r : results)
+	{
+		fout << r.level << " hash " << std::hex << r.hash << std::dec << "\n";
+		for (auto& s : r.systems) fout << r.level << " " << s.system << " " << s.p50 << " " << s.p99 << " " << s.max << "\n";
+	}
+	return true;
+}
+
+//p50 and p99 gate, max is too noisy to fail on and is only printed
+bool Benchmark::Compare(const std::string& baselinePath, const std::vector<LevelResult>& results, float tolerance, std::ostream& out)
+{
+	std::ifstream fin(baselinePath);
+	if (!fin)
+	{
+		std::cerr << "Couldn't open benchmark baseline: " << baselinePath << "\n";
+		return false;
+	}
+
+	std::map<std::string, uint64_t> hashes;
+	std::map<std::pair<std::string, std::string>, Profiler::Summary> baseline;
+	std::string level, system;
+	while (fin >> level >> system)
+	{
+		if (system == "hash") { fin >> std::hex >> hashes[level] >> std::dec; continue; }
+		auto& s = baseline[{ level, system }];
+		fin >> s.p50 >> s.p99 >> s.max;
+	}
+
+	bool passed = true;
+	out << std::fixed << std::setprecision(1);
+	for (auto& r : results)
+	{
+		bool known = hashes.count(r.level) != 0;
+		bool same = known && hashes[r.level] == r.hash;
+		if (!same) passed = false;
+		out << r.level << ": world hash " << std::hex << r.hash << std::dec << (same ? " matches\n" : known ? " CHANGED\n" : " has no baseline\n");
+
+		for (auto& s : r.systems)
+		{
+			auto it = baseline.find({ r.level, s.system });
+			out << "  " << std::left << std::setw(14) << s.system << std::right
+				<< " p50 " << std::setw(8) << s.p50 << "  p99 " << std::setw(8) << s.p99 << "  max " << std::setw(8) << s.max << " us";
+
+			if (it == baseline.end()) { out << "  (new)\n"; continue; }
+
+			auto& b = it->second;
+			bool slower = s.p50 > b.p50 * (1 + tolerance) || s.p99 > b.p99 * (1 + tolerance);
+			if (slower) passed = false;
+			out << "  baseline " << b.p50 << " / " << b.p99 << (slower ? "  REGRESSED\n" : "\n");
+		}
+	}
+	out << std::defaultfloat;
+	return passed;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Scene_Play.h"
+
+#include<string>
+
+//frame time regression check: plays every shipped level and a few generated stress levels headless
+//with the same scripted input, then compares per system frame times and final world hashes to a baseline
+//a hash that differs means gameplay changed, times only fail when they are over the baseline by more than the tolerance
+namespace Benchmark
+{
+	struct LevelResult
+	{
+		std::string level;
+		std::vector<Profiler::Summary> systems;
+		uint64_t hash = 0;
+	};
+
+	std::vector<LevelResult> Run(const Assets& assets, size_t frames);
+	bool WriteBaseline(const std::string& path, const std::vector<LevelResult>& results);
+	bool Compare(const std::string& baselinePath, const std::vector<LevelResult>& results, float tolerance, std::ostream& out);
+};
\ No newline at end of file
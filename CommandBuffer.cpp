@@ -0,0 +1,29 @@
+#include "CommandBuffer.h"
+#include "EntityManager.h"
+
+CommandBuffer::CommandBuffer(EntityManager* manager)
+	:m_manager(manager) {}
+
+//pending, so setting its components doesn't reach the manager's views from this thread
+std::shared_ptr<Entity> CommandBuffer::addEntity(const std::string& tag)
+{
+	auto e = std::shared_ptr<Entity>(new Entity(NO_ID, tag));
+	e->m_manager = m_manager;
+	m_commands.push_back({ Command::CREATE, e, nullptr });
+	return e;
+}
+
+void CommandBuffer::destroy(std::shared_ptr<Entity> entity)
+{
+	m_commands.push_back({ Command::DESTROY, entity, nullptr });
+}
+
+bool CommandBuffer::empty() const
+{
+	return m_commands.empty();
+}
+
+void CommandBuffer::clear()
+{
+	m_commands.clear();
+}
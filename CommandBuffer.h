@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Entity.h"
+
+#include<functional>
+#include<memory>
+#include<vector>
+
+class EntityManager;
+
+//entity operations recorded by one slot of a parallel system and applied by EntityManager::update on the owning thread
+//entities it creates belong to the buffer until then, so the recording thread may set their components directly
+//nothing else may be touched from a worker, edits to live entities are recorded and run at the merge
+class CommandBuffer
+{
+	friend class EntityManager;
+
+	struct Command
+	{
+		enum Type { CREATE, DESTROY, EDIT };
+
+		Type type;
+		std::shared_ptr<Entity> entity;
+		std::function<void(Entity&)> edit;
+	};
+
+	EntityManager* m_manager = nullptr;
+	std::vector<Command> m_commands;
+
+public:
+
+	CommandBuffer(EntityManager* manager = nullptr);
+
+	//the id is assigned when the buffer is merged, until then it reads as NO_ID
+	std::shared_ptr<Entity> addEntity(const std::string& tag);
+	void destroy(std::shared_ptr<Entity> entity);
+
+	template<typename T, typename... TArgs>
+	void addComponent(std::shared_ptr<Entity> entity, TArgs&&... mArgs)
+	{
+		T component(std::forward<TArgs>(mArgs)...);
+		m_commands.push_back({ Command::EDIT, entity, [component](Entity& e) { e.addComponent<T>(component); } });
+	}
+
+	template<typename T>
+	void removeComponent(std::shared_ptr<Entity> entity)
+	{
+		m_commands.push_back({ Command::EDIT, entity, [](Entity& e) { e.removeComponent<T>(); } });
+	}
+
+	bool empty() const;
+	void clear();
+
+	static constexpr size_t NO_ID = (size_t)-1;
+};
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "Animation.h"
 #include"Assets.h"
 
+#include<cstdint>
+
 class Component
 {
 public:
@@ -25,6 +27,7 @@ public:
 		:pos(p), prevPos(p), velocity(sp), scale(sc), angle(a) {}
 };
 
+//frames the entity lives for from frameCreated, the timer wheel destroys it when they are up
 class CLifespan : public Component
 {
 public:
@@ -72,6 +75,7 @@ class CGravity :public Component
 {
 public:
 	float gravity = 0;
+	uint8_t contacts = 0;	//Physics::Contact bits from the last world step, rewritten before anything reads them
 	CGravity() {}
 	CGravity(float g) : gravity(g) {}
 };
@@ -84,4 +88,34 @@ public:
 	bool air = false;
 
 	CState(){}
+};
+
+//data driven enemy behaviour, configured per enemy type by EnemyType lines in the level file
+class CBehaviour :public Component
+{
+public:
+	enum Type : uint8_t
+	{
+		PATROL,	//walk, turn around at walls
+		CHASE,	//patrol until a player is within sight, then walk towards it
+		JUMP	//patrol and jump every interval frames while grounded
+	};
+
+	uint8_t type = PATROL;
+	float speed = 0;		//walking speed, the sign of the level's value is the starting direction
+	float sight = 0;		//chase range in pixels
+	float jump = 0;			//vertical velocity of a jump
+	uint32_t interval = 0;	//frames between jumps
+	uint32_t timer = 0;		//frames until the next jump
+	bool grounded = false;
+
+	//level of detail: a sleeping enemy is parked and replayed later up to the current frame
+	bool asleep = false;
+	size_t frame = 0;		//frames this enemy has been simulated up to while asleep
+	Vec2 sleepVelocity;
+	float sleepGravity = 0;
+
+	CBehaviour() {}
+	CBehaviour(uint8_t t, float s, float si, float j, uint32_t i)
+		:type(t), speed(s), sight(si), jump(j), interval(i), timer(i) {}
 };
\ No newline at end of file
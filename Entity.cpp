@@ -1,4 +1,5 @@
 #include "Entity.h"
+#include "EntityManager.h"
 
 Entity::Entity(const size_t& id, const std::string& tag)
 	:m_id(id), m_tag(tag){}
@@ -15,6 +16,18 @@ const std::string& Entity::tag() const{
 	return m_tag;
 }
 
+Signature Entity::signature() const {
+	return m_signature;
+}
+
+//lets the manager drop any cached views this entity moved in or out of
+void Entity::setSignature(Signature signature) {
+	if (signature == m_signature) return;
+	Signature old = m_signature;
+	m_signature = signature;
+	if (m_manager && !m_pending) m_manager->signatureChanged(old, signature);
+}
+
 void Entity::destroy() {
 	m_active = false;
 }
\ No newline at end of file
@@ -4,34 +4,75 @@
 
 #include<tuple>
 #include<string>
+#include<cstdint>
 
 class EntityManager;
+class CommandBuffer;
 
-typedef std::tuple<CTransform,CLifespan,CInput,CBoundingBox,CAnimation,CGravity,CState> ComponentTuple;
+typedef std::tuple<CTransform,CLifespan,CInput,CBoundingBox,CAnimation,CGravity,CState,CBehaviour> ComponentTuple;
+
+//one bit per component type, set while an entity has that component
+typedef uint32_t Signature;
+static_assert(std::tuple_size<ComponentTuple>::value <= 32, "too many components for a 32 bit signature");
+
+//position of a component type in ComponentTuple, resolved at compile time
+template<typename T, typename Tuple>
+struct ComponentIndex;
+
+template<typename T, typename... Ts>
+struct ComponentIndex<T, std::tuple<T, Ts...>>
+{
+	static const size_t value = 0;
+};
+
+template<typename T, typename U, typename... Ts>
+struct ComponentIndex<T, std::tuple<U, Ts...>>
+{
+	static const size_t value = 1 + ComponentIndex<T, std::tuple<Ts...>>::value;
+};
+
+template<typename T>
+constexpr Signature ComponentBit()
+{
+	return Signature(1) << ComponentIndex<T, ComponentTuple>::value;
+}
+
+template<typename... Ts>
+constexpr Signature SignatureOf()
+{
+	return (ComponentBit<Ts>() | ... | Signature(0));
+}
 
 class Entity
 {
 	friend class EntityManager;
+	friend class CommandBuffer;
 
 	bool m_active = true;
 	std::string m_tag = "default";
 	size_t m_id = 0;
+	bool m_pending = true;	//still in the manager's add list
+	Signature m_signature = 0;
+	EntityManager* m_manager = nullptr;
 	ComponentTuple m_components;
 
 	//constr is private
 	Entity(const size_t& id, const std::string& tag);
 
+	void setSignature(Signature signature);
+
 public:
 
 	void destroy();
 	size_t id() const;
 	bool isActive() const;
 	const std::string& tag() const;
+	Signature signature() const;
 
 	template<typename T>
 	bool hasComponent() const 
 	{
-		return getComponent<T>().has;
+		return (m_signature & ComponentBit<T>()) != 0;
 	}
 
 	template <typename T, typename... TArgs>
@@ -40,6 +81,7 @@ public:
 		auto& component = getComponent<T>();
 		component = T(std::forward<TArgs>(mArgs)...);
 		component.has = true;
+		setSignature(m_signature | ComponentBit<T>());
 		return component;
 	}
 
@@ -58,5 +100,6 @@ public:
 	void removeComponent()
 	{
 		getComponent<T>() = T();
+		setSignature(m_signature & ~ComponentBit<T>());
 	}
 };
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include"EntityManager.h"
 
+#include<cassert>
+#include<set>
+#include<unordered_set>
+
 EntityManager::EntityManager() {}
 
 EntityVector& EntityManager::getEntities() {
@@ -10,20 +14,153 @@ EntityVector& EntityManager::getEntities(const std::string& tag) {
 	return m_entityMap[tag];
 }
 
+EntityVector& EntityManager::view(Signature signature) {
+	auto& v = m_views[signature];
+	if (v.dirty) {
+		v.entities.clear();
+		for (auto& e : m_entities) {
+			if ((e->signature() & signature) == signature) v.entities.push_back(e);
+		}
+		v.dirty = false;
+	}
+	return v.entities;
+}
+
+//only views whose membership test flips for this change are rebuilt, and not until they are next asked for
+void EntityManager::signatureChanged(Signature oldSignature, Signature newSignature) {
+	for (auto& p : m_views) {
+		bool before = (oldSignature & p.first) == p.first;
+		bool after = (newSignature & p.first) == p.first;
+		if (before != after) p.second.dirty = true;
+	}
+}
+
 std::shared_ptr<Entity> EntityManager::addEntity(const std::string& tag) {
 	auto e = std::shared_ptr<Entity>(new Entity(m_totalEntities++, tag));
+	e->m_manager = this;
 	m_toAdd.push_back(e);
 	return e;
 }
 
+void EntityManager::prepareCommands(size_t slots) {
+	if (m_commandBuffers.size() < slots) m_commandBuffers.resize(slots, CommandBuffer(this));
+}
+
+CommandBuffer& EntityManager::commands(size_t slot) {
+	assert(slot < m_commandBuffers.size() && "prepareCommands wasn't called for this slot");
+	return m_commandBuffers[slot];
+}
+
+//buffers in slot order, each in the order it was recorded, so ids and entity order come out the same every run
+//ids are handed out here rather than while recording, a race for id ranges would make them depend on thread timing
+void EntityManager::applyCommands() {
+	for (auto& buffer : m_commandBuffers) {
+		for (auto& command : buffer.m_commands) {
+			switch (command.type) {
+			case CommandBuffer::Command::CREATE:
+				command.entity->m_id = m_totalEntities++;
+				m_toAdd.push_back(command.entity);
+				break;
+			case CommandBuffer::Command::DESTROY:
+				command.entity->destroy();
+				break;
+			case CommandBuffer::Command::EDIT:
+				command.edit(*command.entity);
+				break;
+			}
+		}
+		buffer.clear();
+	}
+}
+
+std::shared_ptr<Entity> EntityManager::restoreEntity(const std::string& tag, size_t id) {
+	auto e = std::shared_ptr<Entity>(new Entity(id, tag));
+	e->m_manager = this;
+	return e;
+}
+
+void EntityManager::setActive(Entity& e, bool active) {
+	e.m_active = active;
+}
+
+//entities are in id order in both lists, so when the same entities are live the lists are already right and a
+//restore that only patched components leaves every view and tag list alone
+void EntityManager::restore(const EntityVector& live, const EntityVector& pending, size_t totalEntities) {
+	for (auto& buffer : m_commandBuffers) buffer.clear();
+	m_totalEntities = totalEntities;
+
+	std::unordered_set<const Entity*> before;
+	before.reserve(m_entities.size());
+	for (auto& e : m_entities) before.insert(e.get());
+
+	std::set<std::string> tags;
+	auto moved = [&](const Entity& e) {
+		tags.insert(e.tag());
+		for (auto& p : m_views) {
+			if ((e.signature() & p.first) == p.first) p.second.dirty = true;
+		}
+	};
+	for (auto& e : live) {
+		if (before.erase(e.get()) == 0) moved(*e);
+		e->m_pending = false;
+	}
+	for (auto& e : m_entities) {
+		if (before.count(e.get())) moved(*e);
+	}
+
+	if (!tags.empty()) {
+		m_entities = live;
+		for (auto& tag : tags) {
+			auto& list = m_entityMap[tag];
+			list.clear();
+			for (auto& e : live) { if (e->tag() == tag) list.push_back(e); }
+		}
+	}
+
+	m_toAdd = pending;
+	for (auto& e : m_toAdd) e->m_pending = true;
+}
+
+void EntityManager::clear(size_t totalEntities) {
+	m_entities.clear();
+	m_toAdd.clear();
+	for (auto& buffer : m_commandBuffers) buffer.clear();
+	for (auto& p : m_entityMap) {
+		p.second.clear();
+	}
+	for (auto& p : m_views) {
+		p.second.entities.clear();
+		p.second.dirty = true;
+	}
+	m_totalEntities = totalEntities;
+}
+
+const EntityVector& EntityManager::getPendingEntities() const {
+	return m_toAdd;
+}
+
+const EntityMap& EntityManager::getEntityMap() const {
+	return m_entityMap;
+}
+
+size_t EntityManager::totalEntities() const {
+	return m_totalEntities;
+}
+
 void EntityManager::removeDeadEntities(EntityVector& ev) {
 	ev.erase(std::remove_if(ev.begin(), ev.end(), [](auto e) { return (e->isActive() == false); }), ev.end());
 }
 
 void EntityManager::update() {
+	applyCommands();
+
 	for (auto e : m_toAdd) {
+		e->m_pending = false;
 		m_entities.push_back(e);
 		m_entityMap[e->tag()].push_back(e);
+		for (auto& p : m_views) {
+			if (!p.second.dirty && (e->signature() & p.first) == p.first) p.second.entities.push_back(e);
+		}
 	}
 	m_toAdd.clear();
 
@@ -31,4 +168,7 @@ void EntityManager::update() {
 	for (auto& p : m_entityMap) {
 		removeDeadEntities(p.second);
 	}
+	for (auto& p : m_views) {
+		removeDeadEntities(p.second.entities);
+	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include"Entity.h"
+#include"CommandBuffer.h"
 //#include<string>
 //#include<vector>
 //#include<map>
@@ -11,12 +12,25 @@ typedef std::map<std::string, EntityVector> EntityMap;
 
 class EntityManager
 {
+	friend class Entity;
+
+	//entities having every component in a signature, in the same order as m_entities
+	struct View
+	{
+		EntityVector entities;
+		bool dirty = true;
+	};
+
 	EntityVector m_entities;
 	EntityVector m_toAdd;
 	EntityMap m_entityMap;
+	std::map<Signature, View> m_views;
 	size_t m_totalEntities = 0;
+	std::vector<CommandBuffer> m_commandBuffers;	//one per slot of a parallel system, merged in slot order
 
 	void removeDeadEntities(EntityVector& vec);
+	void applyCommands();
+	void signatureChanged(Signature oldSignature, Signature newSignature);
 
 public:
 
@@ -26,6 +40,31 @@ public:
 
 	std::shared_ptr<Entity> addEntity(const std::string& type);
 
+	//call on the owning thread before a parallel system starts, then each slot records into its own buffer
+	//slots are work items rather than threads, so what gets recorded and the merge order don't depend on scheduling
+	void prepareCommands(size_t slots);
+	CommandBuffer& commands(size_t slot);
+
+	//an entity with a known id for restoring saved state, it isn't in any list until restore is called
+	std::shared_ptr<Entity> restoreEntity(const std::string& tag, size_t id);
+	//brings back an entity destroyed after the state being restored was saved
+	void setActive(Entity& e, bool active);
+	//makes the live and add lists exactly these, only views and tags of entities that joined or left are rebuilt
+	void restore(const EntityVector& live, const EntityVector& pending, size_t totalEntities);
+	void clear(size_t totalEntities);
+
 	EntityVector& getEntities();
 	EntityVector& getEntities(const std::string& tag);
+	EntityVector& view(Signature signature);
+
+	//entities that have all of the given components, cached until one of them changes
+	template<typename... Ts>
+	EntityVector& view()
+	{
+		return view(SignatureOf<Ts...>());
+	}
+
+	const EntityVector& getPendingEntities() const;
+	const EntityMap& getEntityMap() const;
+	size_t totalEntities() const;
 };
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "Environment.h"
+
+Environment::Environment(const Assets& assets, size_t worldCount, size_t threadCount)
+	:m_pool(assets, threadCount)
+	, m_info(worldCount)
+{
+	//built once so handing it to the pool every step doesn't allocate
+	m_stepJob = [this](Scene_Play& world, size_t index) { stepWorld(world, index); };
+}
+
+//(re)creates every world on the given level, observations holds size() * OBSERVATION_SIZE floats
+void Environment::reset(const std::string& levelPath, float* observations)
+{
+	m_levelPath = levelPath;
+	for (size_t i = 0; i < m_info.size(); i++)
+	{
+		if (i < m_pool.size()) m_pool.resetWorld(i, levelPath);
+		else m_pool.addWorld(levelPath);
+		startWorld(i, observations + i * OBSERVATION_SIZE);
+	}
+}
+
+//restarts a single world on the current level, typically once it reported done
+void Environment::reset(size_t index, float* observation)
+{
+	m_pool.resetWorld(index, m_levelPath);
+	startWorld(index, observation);
+}
+
+void Environment::startWorld(size_t index, float* observation)
+{
+	auto& world = m_pool.world(index);
+	auto& info = m_info[index];
+	info = WorldInfo();
+	info.bestX = world.player()->getComponent<CTransform>().pos.x;
+	info.lives = world.lives();
+
+	observe(world, info, observation);
+}
+
+void Environment::step(const uint8_t* actions, size_t frames, float* observations, float* rewards, uint8_t* dones)
+{
+	m_actions = actions;
+	m_frames = frames;
+	m_observations = observations;
+	m_rewards = rewards;
+	m_dones = dones;
+
+	m_pool.forEach(m_stepJob);
+}
+
+void Environment::stepWorld(Scene_Play& world, size_t index)
+{
+	auto& info = m_info[index];
+	float reward = 0;
+
+	if (!info.done)
+	{
+		world.setInputMask(0, m_actions[index]);
+		world.simulate(m_frames);
+
+		//new ground covered, in tiles
+		float x = world.player()->getComponent<CTransform>().pos.x;
+		if (x > info.bestX)
+		{
+			reward += (x - info.bestX) / world.gridSize().x;
+			info.bestX = x;
+		}
+
+		if (world.lives() < info.lives) reward -= 10.f * (info.lives - world.lives());
+		info.lives = world.lives();
+
+		//the level only ends with lives left when the player reached the pole
+		if (world.hasEnded())
+		{
+			info.done = true;
+			if (world.lives() > 0) reward += 100.f;
+		}
+	}
+
+	m_rewards[index] = reward;
+	m_dones[index] = info.done;
+	observe(world, info, m_observations + index * OBSERVATION_SIZE);
+}
+
+void Environment::observe(Scene_Play& world, const WorldInfo& info, float* out) const
+{
+	const Vec2& grid = world.gridSize();
+	auto player = world.player();
+	auto& transform = player->getComponent<CTransform>();
+
+	out[0] = transform.pos.x / grid.x;
+	out[1] = transform.pos.y / grid.y;
+	out[2] = transform.velocity.x / grid.x;
+	out[3] = transform.velocity.y / grid.y;
+	out[4] = player->getComponent<CState>().air ? 1.f : 0.f;
+	out[5] = (float)info.lives;
+
+	//tile window: 0 empty, 1 solid, 2 brick or question block
+	float* cells = out + PLAYER_FEATURES;
+	std::fill(cells, cells + GRID_WIDTH * GRID_HEIGHT, 0.f);
+
+	int px = (int)std::floor(transform.pos.x / grid.x);
+	int py = (int)std::floor(transform.pos.y / grid.y);
+	for (auto& tile : world.entities().getEntities("Tile"))
+	{
+		if (!tile->isActive()) continue;
+
+		auto& pos = tile->getComponent<CTransform>().pos;
+
+		//a merged collider has no animation and covers every cell under its box
+		if (!tile->hasComponent<CAnimation>())
+		{
+			auto& half = tile->getComponent<CBoundingBox>().halfSize;
+			int left = std::max((int)std::floor((pos.x - half.x) / grid.x + 0.5f) - px + GRID_WIDTH / 2, 0);
+			int right = std::min((int)std::ceil((pos.x + half.x) / grid.x - 0.5f) - px + GRID_WIDTH / 2, GRID_WIDTH);
+			int top = std::max((int)std::floor((pos.y - half.y) / grid.y + 0.5f) - py + GRID_HEIGHT / 2, 0);
+			int bottom = std::min((int)std::ceil((pos.y + half.y) / grid.y - 0.5f) - py + GRID_HEIGHT / 2, GRID_HEIGHT);
+			for (int cy = top; cy < bottom; cy++)
+			{
+				for (int cx = left; cx < right; cx++) cells[cy * GRID_WIDTH + cx] = std::max(cells[cy * GRID_WIDTH + cx], 1.f);
+			}
+			continue;
+		}
+
+		int cx = (int)std::floor(pos.x / grid.x) - px + GRID_WIDTH / 2;
+		int cy = (int)std::floor(pos.y / grid.y) - py + GRID_HEIGHT / 2;
+		if (cx < 0 || cx >= GRID_WIDTH || cy < 0 || cy >= GRID_HEIGHT) continue;
+
+		auto& name = tile->getComponent<CAnimation>().animation.getName();
+		cells[cy * GRID_WIDTH + cx] = (name == "Brick" || name == "Question") ? 2.f : 1.f;
+	}
+
+	//nearest enemies by squared distance, kept sorted in a fixed size array
+	float distance[NEARBY_ENEMIES];
+	Entity* nearest[NEARBY_ENEMIES];
+	size_t found = 0;
+	for (auto& enemy : world.entities().getEntities("Enemy"))
+	{
+		if (!enemy->isActive()) continue;
+
+		float d = enemy->getComponent<CTransform>().pos.dist(transform.pos);
+		if (found == NEARBY_ENEMIES && d >= distance[found - 1]) continue;
+
+		size_t i = (found < NEARBY_ENEMIES) ? found++ : found - 1;
+		while (i > 0 && distance[i - 1] > d)
+		{
+			distance[i] = distance[i - 1];
+			nearest[i] = nearest[i - 1];
+			i--;
+		}
+		distance[i] = d;
+		nearest[i] = enemy.get();
+	}
+
+	float* enemies = cells + GRID_WIDTH * GRID_HEIGHT;
+	for (size_t i = 0; i < NEARBY_ENEMIES; i++)
+	{
+		float* e = enemies + i * ENEMY_FEATURES;
+		if (i < found)
+		{
+			auto& t = nearest[i]->getComponent<CTransform>();
+			e[0] = (t.pos.x - transform.pos.x) / grid.x;
+			e[1] = (t.pos.y - transform.pos.y) / grid.y;
+			e[2] = t.velocity.x / grid.x;
+		}
+		else
+		{
+			e[0] = e[1] = e[2] = 0.f;
+		}
+	}
+}
+
+size_t Environment::size() const
+{
+	return m_info.size();
+}
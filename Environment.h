@@ -0,0 +1,65 @@
+#pragma once
+
+#include "WorldPool.h"
+
+#include<cstdint>
+
+//programmatic front end for automated agents, drives a batch of headless worlds
+//step() takes one action mask per world and writes observations, rewards and done flags
+//into caller owned contiguous buffers, the environment itself allocates nothing per step
+class Environment
+{
+public:
+
+	enum ActionBits : uint8_t
+	{
+		ACTION_JUMP		= Scene_Play::INPUT_JUMP,
+		ACTION_LEFT		= Scene_Play::INPUT_LEFT,
+		ACTION_RIGHT	= Scene_Play::INPUT_RIGHT,
+		ACTION_SHOOT	= Scene_Play::INPUT_SHOOT
+	};
+
+	static const int GRID_WIDTH = 11;	//tiles in the window around the player, player in the middle
+	static const int GRID_HEIGHT = 9;
+	static const size_t NEARBY_ENEMIES = 4;
+
+	//x, y, vx, vy, in air, lives | tile grid | dx, dy, vx per enemy, in grid units
+	static const size_t PLAYER_FEATURES = 6;
+	static const size_t ENEMY_FEATURES = 3;
+	static const size_t OBSERVATION_SIZE = PLAYER_FEATURES + GRID_WIDTH * GRID_HEIGHT + NEARBY_ENEMIES * ENEMY_FEATURES;
+
+private:
+
+	struct WorldInfo
+	{
+		float bestX = 0;		//furthest the player got, reward is paid for new ground only
+		int lives = 0;
+		bool done = false;
+	};
+
+	WorldPool m_pool;
+	std::vector<WorldInfo> m_info;
+	std::string m_levelPath;
+
+	//arguments of the step in flight, read by m_stepJob on the worker threads
+	const uint8_t* m_actions = nullptr;
+	size_t m_frames = 1;
+	float* m_observations = nullptr;
+	float* m_rewards = nullptr;
+	uint8_t* m_dones = nullptr;
+	std::function<void(Scene_Play&, size_t)> m_stepJob;
+
+	void startWorld(size_t index, float* observation);
+	void stepWorld(Scene_Play& world, size_t index);
+	void observe(Scene_Play& world, const WorldInfo& info, float* out) const;
+
+public:
+
+	Environment(const Assets& assets, size_t worldCount, size_t threadCount = 0);
+
+	void reset(const std::string& levelPath, float* observations);
+	void reset(size_t index, float* observation);
+	void step(const uint8_t* actions, size_t frames, float* observations, float* rewards, uint8_t* dones);
+
+	size_t size() const;
+};
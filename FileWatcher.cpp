@@ -0,0 +1,99 @@
+#include "FileWatcher.h"
+
+#ifdef __linux__
+#include<sys/inotify.h>
+#include<unistd.h>
+#include<climits>
+#endif
+
+#include<algorithm>
+
+std::string FileWatcher::normalize(const std::string& path)
+{
+	return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher()
+{
+	m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+}
+
+FileWatcher::~FileWatcher()
+{
+	if (m_fd >= 0) close(m_fd);
+}
+
+//editors often save by writing a new file and renaming it over the old one,
+//so the directory is watched rather than the file itself
+void FileWatcher::watch(const std::string& path)
+{
+	std::string file = normalize(path);
+	if (!m_files.insert(file).second || m_fd < 0) return;
+
+	std::string directory = std::filesystem::path(file).parent_path().generic_string();
+	if (directory.empty()) directory = ".";
+	if (m_watches.count(directory)) return;
+
+	int wd = inotify_add_watch(m_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+	if (wd < 0) return;
+	m_watches[directory] = wd;
+	m_directories[wd] = directory;
+}
+
+void FileWatcher::poll(std::vector<std::string>& changed)
+{
+	if (m_fd < 0) return;
+
+	alignas(inotify_event) char buffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+	ssize_t length;
+	while ((length = read(m_fd, buffer, sizeof(buffer))) > 0)
+	{
+		for (char* p = buffer; p < buffer + length;)
+		{
+			auto event = reinterpret_cast<inotify_event*>(p);
+			p += sizeof(inotify_event) + event->len;
+			if (event->len == 0 || !m_directories.count(event->wd)) continue;
+
+			std::string directory = m_directories[event->wd];
+			std::string file = normalize(directory == "." ? event->name : directory + "/" + event->name);
+			if (m_files.count(file) && std::find(changed.begin(), changed.end(), file) == changed.end())
+			{
+				changed.push_back(file);
+			}
+		}
+	}
+}
+
+#else
+
+FileWatcher::FileWatcher() {}
+
+FileWatcher::~FileWatcher() {}
+
+void FileWatcher::watch(const std::string& path)
+{
+	std::string file = normalize(path);
+	if (!m_files.insert(file).second) return;
+
+	std::error_code error;
+	m_times[file] = std::filesystem::last_write_time(file, error);
+}
+
+void FileWatcher::poll(std::vector<std::string>& changed)
+{
+	if (++m_calls % POLL_INTERVAL != 0) return;
+
+	for (auto& p : m_times)
+	{
+		std::error_code error;
+		auto time = std::filesystem::last_write_time(p.first, error);
+		if (error || time == p.second) continue;
+
+		p.second = time;
+		changed.push_back(p.first);
+	}
+}
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include<map>
+#include<set>
+#include<string>
+#include<vector>
+#include<filesystem>
+
+//reports files that were written since the last poll
+//uses inotify on linux, elsewhere it falls back to comparing modification times
+class FileWatcher
+{
+	std::set<std::string> m_files;
+
+#ifdef __linux__
+	int m_fd = -1;
+	std::map<int, std::string> m_directories;	//inotify watch descriptor -> watched directory
+	std::map<std::string, int> m_watches;
+#else
+	static const size_t POLL_INTERVAL = 30;		//calls between checks of the modification times
+	std::map<std::string, std::filesystem::file_time_type> m_times;
+	size_t m_calls = 0;
+#endif
+
+public:
+
+	static std::string normalize(const std::string& path);
+
+	FileWatcher();
+	~FileWatcher();
+
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+
+	void watch(const std::string& path);
+	void poll(std::vector<std::string>& changed);
+};
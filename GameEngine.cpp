@@ -1,14 +1,22 @@
 #include "GameEngine.h"
+#include "MemoryStats.h"
+
+#include<algorithm>
+#include<chrono>
+#include<thread>
 
 GameEngine::GameEngine(const std::string& path) 
+    :m_audio(m_assets)
 {
 	init(path);
 }
 
 void GameEngine::init(const std::string& path)
 {
-	//load all assets at one to be used in scenes
+	//only reads the asset list, scenes load what they use
+	m_assetPath = path;
 	m_assets.loadFromFile(path);
+	watchAssets();
 
 	//set sfml window shared by all scenes
 	m_window.create(sf::VideoMode(1280, 768), "Not Mario",sf::Style::Close | sf::Style::Titlebar);
@@ -19,10 +27,58 @@ void GameEngine::init(const std::string& path)
 	changeScene("MENU", std::make_shared<Scene_Menu>(this));
 }
 
-void GameEngine::update()
+//one simulation tick, runs on the simulation thread
+//presses and releases that land in the same tick are all applied, in the order they happened
+void GameEngine::update(Clock::time_point tickTime)
+{
+	std::lock_guard<std::mutex> lock(m_simMutex);
+
+	auto now = Clock::now();
+	while (auto event = m_input.front())
+	{
+		if (event->time > tickTime) break;
+
+		double latency = std::chrono::duration<double>(now - event->time).count();
+		m_inputLatency.events++;
+		m_inputLatency.total += latency;
+		m_inputLatency.worst = std::max(m_inputLatency.worst, latency);
+		if (latency > 1.0 / 60) m_inputLatency.late++;
+
+		//a scene change between the key and the tick means the action name came from another scene's bindings
+		if (event->scene.lock() == currentScene()) currentScene()->sDoAction(event->action);
+		m_input.pop();
+	}
+
+	m_audio.update();
+	currentScene()->update();
+
+	//a finished build is dropped here, on the thread that owns the assets it releases
+	auto done = [](std::future<std::shared_ptr<Scene_Play>>& f) { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+	m_orphanedBuilds.erase(std::remove_if(m_orphanedBuilds.begin(), m_orphanedBuilds.end(), done), m_orphanedBuilds.end());
+	MemoryStats::EndFrame();
+}
+
+//ticks at a fixed 60hz no matter how long frames take to draw, drops the backlog rather than spiralling if it falls behind
+void GameEngine::simulationLoop()
+{
+	const auto tick = std::chrono::microseconds(1000000 / 60);
+	auto next = Clock::now();
+	while (m_running)
+	{
+		update(next);
+
+		next += tick;
+		auto now = Clock::now();
+		if (now > next + tick * 4) next = now;
+		std::this_thread::sleep_until(next);
+	}
+}
+
+void GameEngine::InputLatency::print(std::ostream& out) const
 {
-	sUserInput();
-	m_sceneMap.at(m_currentScene)->update();
+	out << "input latency: " << events << " events";
+	if (events) out << ", avg " << total / events * 1000 << "ms, worst " << worst * 1000 << "ms, " << late << " over one tick";
+	out << "\n";
 }
 
 //hanfle raw input from users, mapping input to logic donw in scene class
@@ -36,22 +92,82 @@ void GameEngine::sUserInput()
         if (event.type == sf::Event::KeyPressed || event.type == sf::Event::KeyReleased)
         {
             // If the current scene does not have an action associated with this key, skip the event
-            if (currentScene()->getActionMap().find(event.key.code) == currentScene()->getActionMap().end()) { continue; }
+            auto scene = renderScene();
+            if (scene->getActionMap().find(event.key.code) == scene->getActionMap().end()) { continue; }
 
             // Determine start or end action by whether it was key press or release
             const std::string actionType = (event.type == sf::Event::KeyPressed) ? "START" : "END";
 
-            // Look up action and send action to the scene to be executed
-            currentScene()->sDoAction(Action(currentScene()->getActionMap().at(event.key.code), actionType));
+            // Queue the action for the simulation thread, it is executed by the first tick that starts after now
+            if (!m_input.push({ Action(scene->getActionMap().at(event.key.code), actionType), scene, Clock::now() }))
+            {
+                std::cerr << "Input queue full, dropped " << scene->getActionMap().at(event.key.code) << "\n";
+            }
         }
     }
 }
 
+//picks up edited files without restarting, only what changed is reloaded
+void GameEngine::sHotReload()
+{
+    std::vector<std::string> changed;
+    {
+        std::lock_guard<std::mutex> lock(m_watchMutex);
+        m_watcher.poll(changed);
+    }
+    if (changed.empty()) return;
+
+    //textures and entities are shared with the simulation, so it sits out while they change
+    std::lock_guard<std::mutex> lock(m_simMutex);
+
+    std::set<std::string> animations;
+    for (auto& path : changed)
+    {
+        if (path == FileWatcher::normalize(m_assetPath))
+        {
+            m_assets.reloadFromFile(m_assetPath, animations);
+            watchAssets();
+        }
+        else
+        {
+            for (auto& t : m_assets.getTexturePaths())
+            {
+                if (FileWatcher::normalize(t.second) == path) m_assets.reloadTexture(t.first, animations);
+            }
+        }
+
+        currentScene()->onFileChanged(path);
+    }
+
+    //scenes kept in the map but not running are rebuilt before they are shown again
+    if (animations.empty()) return;
+    currentScene()->onAssetsReloaded(animations);
+}
+
+void GameEngine::watchAssets()
+{
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    m_watcher.watch(m_assetPath);
+    for (auto& t : m_assets.getTexturePaths()) m_watcher.watch(t.second);
+}
+
+void GameEngine::watchFile(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_watchMutex);
+    m_watcher.watch(path);
+}
+
 std::shared_ptr<Scene> GameEngine::currentScene()
 {
     return m_sceneMap.at(m_currentScene);
 }
 
+std::shared_ptr<Scene> GameEngine::renderScene()
+{
+    std::lock_guard<std::mutex> lock(m_sceneMutex);
+    return m_renderScene;
+}
+
 void GameEngine::changeScene(const std::string& sceneName, std::shared_ptr<Scene> scene, bool endCurrentScene)
 {
     /*
@@ -62,8 +178,27 @@ void GameEngine::changeScene(const std::string& sceneName, std::shared_ptr<Scene
     }
     */
 
+    //report what the outgoing scene cost before it is replaced
+    if (m_sceneMap.find(m_currentScene) != m_sceneMap.end()) currentScene()->reportMemory(std::cout);
+
+    //an ended scene is dropped so its assets are released, the caller's shared_ptr keeps it alive until its update returns
+    if (endCurrentScene && m_currentScene != sceneName) m_sceneMap.erase(m_currentScene);
+
     m_sceneMap[sceneName] = scene;
     m_currentScene = sceneName;
+
+    {
+        std::lock_guard<std::mutex> lock(m_sceneMutex);
+        m_renderScene = scene;
+    }
+
+    //music is streamed in the background and crossfaded, so switching never waits on it
+    if (!scene->musicName().empty()) m_audio.playMusic(scene->musicName());
+}
+
+void GameEngine::adoptBuild(std::future<std::shared_ptr<Scene_Play>> build)
+{
+    if (build.valid()) m_orphanedBuilds.push_back(std::move(build));
 }
 
 void GameEngine::quit()
@@ -71,12 +206,21 @@ void GameEngine::quit()
     m_running = false;
 }
 
+//simulation runs on its own thread, this one polls the window, applies hot reloads and draws the newest frame
 void GameEngine::run()
 {
+    std::thread simulation(&GameEngine::simulationLoop, this);
+
     while (isRunning())
     {
-        update();
+        sUserInput();
+        sHotReload();
+        renderScene()->sRender();
     }
+
+    m_running = false;
+    simulation.join();
+    m_inputLatency.print(std::cout);
 }
 
 sf::RenderWindow& GameEngine::window()
@@ -84,9 +228,14 @@ sf::RenderWindow& GameEngine::window()
     return m_window;
 }
 
-sf::Music& GameEngine::music()
+RenderStats& GameEngine::renderStats()
+{
+    return m_renderStats;
+}
+
+Audio& GameEngine::audio()
 {
-    return m_music;
+    return m_audio;
 }
 
 const Assets& GameEngine::assets() const
@@ -3,41 +3,94 @@
 #include "Scene.h"
 #include "Scene_Menu.h"
 #include "Assets.h"
+#include "Audio.h"
+#include "FileWatcher.h"
+#include "SpscQueue.h"
 
-#include<SFML/Audio.hpp>
+#include<atomic>
+#include<chrono>
+#include<future>
+#include<mutex>
+#include<vector>
+
+class Scene_Play;
 
 typedef std::map<std::string, std::shared_ptr<Scene>> SceneMap;
+typedef std::chrono::steady_clock Clock;
 
 class GameEngine
 {
+	//an action, the scene whose keys it was mapped with and the moment the event pump saw it
+	struct InputEvent
+	{
+		Action action;
+		std::weak_ptr<Scene> scene;
+		Clock::time_point time;
+	};
+
+	//time from an event being pumped to the tick that applied it
+	struct InputLatency
+	{
+		size_t events = 0;
+		size_t late = 0;	//waited longer than one tick
+		double total = 0;	//seconds
+		double worst = 0;
+
+		void print(std::ostream& out) const;
+	};
+
 protected:
 
 	sf::RenderWindow m_window;
-	sf::Music m_music;
+	RenderStats m_renderStats{ m_window };	//every draw to the window goes through this, only used on the main thread
 	Assets m_assets;
+	Audio m_audio;
+	FileWatcher m_watcher;
+	std::mutex m_watchMutex;	//levels start watching their file from whatever thread builds them
+	std::string m_assetPath;
 	std::string m_currentScene;
-	SceneMap m_sceneMap;
+	std::vector<std::future<std::shared_ptr<Scene_Play>>> m_orphanedBuilds;	//level builds nobody waits for, reaped once done
+	SceneMap m_sceneMap;	//after the builds, a menu destroyed with it hands its own builds over
 	size_t m_simulationSpeed = 1;
-	bool m_running = true;
+	std::atomic<bool> m_running{ true };
+
+	//the simulation thread holds this for a whole tick, the main thread takes it to touch the world
+	std::mutex m_simMutex;
+
+	//actions polled on the main thread, each tick applies the ones pumped before it started
+	SpscQueue<InputEvent, 256> m_input;
+	InputLatency m_inputLatency;	//only touched by the simulation thread
+
+	//scene the main thread draws, swapped by changeScene
+	std::mutex m_sceneMutex;
+	std::shared_ptr<Scene> m_renderScene;
 
 	void init(const std::string& path);
-	void update();
+	void update(Clock::time_point tickTime);
+	void simulationLoop();
 
 	void sUserInput();
+	void sHotReload();
+	void watchAssets();
 
 	std::shared_ptr<Scene> currentScene();
+	std::shared_ptr<Scene> renderScene();
 
 public:
 
 	GameEngine(const std::string& path);
 
 	void changeScene(const std::string& sceneName, std::shared_ptr<Scene> scene, bool endCurrentScene = false);
+	//takes over a level build whose scene is going away, so letting go of it never waits for it to finish
+	void adoptBuild(std::future<std::shared_ptr<Scene_Play>> build);
 
+	void watchFile(const std::string& path);
 	void quit();
 	void run();
 
 	sf::RenderWindow& window();
-	sf::Music& music();
+	RenderStats& renderStats();
+	Audio& audio();
 	const Assets& assets() const;
 	bool isRunning();
 };
\ No newline at end of file
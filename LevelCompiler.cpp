@@ -0,0 +1,181 @@
+#include "LevelCompiler.h"
+
+#include<map>
+#include<set>
+#include<sstream>
+
+//tiles the player can break, empty or finish the level on need an entity of their own
+static bool isInteractive(const std::string& animationName)
+{
+	return animationName == "Brick" || animationName == "Question" || animationName == "Pole";
+}
+
+//only tiles that fill exactly one grid cell line up with their neighbours
+static bool isMergeable(const std::string& animationName, const Assets& assets, const Vec2& gridSize)
+{
+	if (isInteractive(animationName)) return false;
+
+	return assets.animationSize(animationName) == gridSize;
+}
+
+size_t LevelCompiler::Stats::collidersBefore() const
+{
+	return tiles;
+}
+
+size_t LevelCompiler::Stats::collidersAfter() const
+{
+	return tiles - merged + colliders;
+}
+
+//  Tile/Dec <animation> <gx> <gy>
+//  Merged <animation> <gx> <gy>		(written by the compiler, a tile a collider covers, spawned as a Dec)
+//  Collider <gx> <gy> <width> <height>	(written by the compiler, in grid cells)
+//  Player <gx> <gy> <cw> <ch> <speed> <jump> <maxspeed> <gravity> <weapon>
+//  EnemyType <animation> <Patrol|Chase|Jump> <sight> <jump> <jump interval> <gravity>
+//  Enemy <animation> <gx> <gy> <speed>
+//an EnemyType line must come before the enemies it configures, enemies without one patrol
+std::vector<std::string> LevelCompiler::Read(const std::string& filename)
+{
+	std::vector<std::string> entries;
+	std::map<std::string, size_t> seen;
+
+	std::ifstream fin(filename);
+	std::string entityType="";
+	while (fin >> entityType) 
+	{
+		size_t fields = 0;
+		if (entityType == "Tile" || entityType == "Dec" || entityType == "Merged") fields = 3;
+		else if (entityType == "Collider") fields = 4;
+		else if (entityType == "Player") fields = 9;
+		else if (entityType == "Enemy") fields = 4;
+		else if (entityType == "EnemyType") fields = 6;
+		else
+		{
+			std::cerr << "Unknown entity name in level file: " << filename << "\n";
+			continue;
+		}
+
+		std::string entry = entityType, field;
+		for (size_t i = 0; i < fields && fin >> field; i++) entry += " " + field;
+
+		size_t count = seen[entry]++;
+		if (count > 0) entry += " #" + std::to_string(count);
+		entries.push_back(entry);
+	}
+	return entries;
+}
+
+//every animation a tile, decoration or enemy entry names
+Assets::Manifest LevelCompiler::Manifest(const std::vector<std::string>& entries)
+{
+	Assets::Manifest manifest;
+	for (auto& entry : entries)
+	{
+		std::istringstream fin(entry);
+		std::string entityType, animationName;
+		fin >> entityType >> animationName;
+		if (entityType == "Tile" || entityType == "Dec" || entityType == "Merged" || entityType == "Enemy") manifest.animations.insert(animationName);
+	}
+	return manifest;
+}
+
+bool LevelCompiler::IsStatic(const std::string& entry)
+{
+	return entry.compare(0, 5, "Tile ") == 0 || entry.compare(0, 4, "Dec ") == 0 || entry.compare(0, 7, "Merged ") == 0
+		|| entry.compare(0, 9, "Collider ") == 0;
+}
+
+//greedy meshing: from the lowest, leftmost free cell grow right as far as the row goes,
+//then grow up while the whole span of the next row is free, repeat until every cell is covered
+std::vector<std::string> LevelCompiler::Compile(const std::vector<std::string>& entries, const Assets& assets, const Vec2& gridSize, Stats& stats)
+{
+	stats = Stats();
+
+	std::vector<std::string> compiled;
+	compiled.reserve(entries.size());
+	std::set<std::pair<int, int>> cells;	//(gy, gx) so the set iterates row by row
+
+	for (auto& entry : entries)
+	{
+		if (entry.compare(0, 5, "Tile ") != 0)
+		{
+			compiled.push_back(entry);
+			continue;
+		}
+
+		std::istringstream fin(entry);
+		std::string entityType, animationName;
+		int gx, gy;
+		fin >> entityType >> animationName >> gx >> gy;
+		stats.tiles++;
+
+		if (!isMergeable(animationName, assets, gridSize))
+		{
+			compiled.push_back(entry);
+			continue;
+		}
+
+		//its own type rather than Dec, an identical Dec entry in the source would otherwise share its key
+		compiled.push_back("Merged" + entry.substr(4));
+		cells.insert({ gy, gx });
+		stats.merged++;
+	}
+
+	std::set<std::pair<int, int>> taken;
+	auto isFree = [&](int gy, int gx) { return cells.count({ gy, gx }) && !taken.count({ gy, gx }); };
+
+	for (auto& cell : cells)
+	{
+		int gy = cell.first, gx = cell.second;
+		if (taken.count(cell)) continue;
+
+		int w = 1;
+		while (isFree(gy, gx + w)) w++;
+
+		int h = 1;
+		for (;; h++)
+		{
+			bool rowFree = true;
+			for (int x = gx; x < gx + w && rowFree; x++) rowFree = isFree(gy + h, x);
+			if (!rowFree) break;
+		}
+
+		for (int y = gy; y < gy + h; y++)
+		{
+			for (int x = gx; x < gx + w; x++) taken.insert({ y, x });
+		}
+
+		std::ostringstream collider;
+		collider << "Collider " << gx << " " << gy << " " << w << " " << h;
+		compiled.push_back(collider.str());
+		stats.colliders++;
+	}
+
+	return compiled;
+}
+
+//drops the #n suffixes again, reading the file back gives the same entries
+bool LevelCompiler::Write(const std::string& filename, const std::vector<std::string>& entries)
+{
+	std::ofstream fout(filename);
+	if (!fout)
+	{
+		std::cerr << "Couldn't write level file: " << filename << "\n";
+		return false;
+	}
+
+	for (auto& entry : entries)
+	{
+		size_t suffix = entry.find(" #");
+		fout << entry.substr(0, suffix) << "\n";
+	}
+	return true;
+}
+
+void LevelCompiler::PrintStats(const std::string& name, const Stats& stats, std::ostream& out)
+{
+	out << name << ": " << stats.collidersBefore() << " tile colliders -> " << stats.collidersAfter()
+		<< " (" << stats.merged << " tiles merged into " << stats.colliders << " rectangles, "
+		<< stats.tiles - stats.merged << " kept)\n";
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Assets.h"
+#include "Vec2.h"
+
+#include<string>
+#include<vector>
+
+//turns a level file into the entries Scene_Play spawns from, also usable offline through --compile-level
+//plain solid tiles are merged into as few rectangular colliders as possible, each merged tile stays
+//behind as a Merged entry that draws like a Dec, tiles the player can interact with keep their own box
+//compiling an already compiled level changes nothing
+namespace LevelCompiler
+{
+	struct Stats
+	{
+		size_t tiles = 0;		//Tile entries in the source
+		size_t merged = 0;		//tiles folded into a collider
+		size_t colliders = 0;	//rectangles they were folded into
+
+		size_t collidersBefore() const;
+		size_t collidersAfter() const;
+	};
+
+	//one string per entity, repeated entries get a #n suffix so each one stays unique
+	std::vector<std::string> Read(const std::string& filename);
+	Assets::Manifest Manifest(const std::vector<std::string>& entries);
+	bool IsStatic(const std::string& entry);	//tile, decoration, merged tile or collider, spawns without reading any other entry
+	std::vector<std::string> Compile(const std::vector<std::string>& entries, const Assets& assets, const Vec2& gridSize, Stats& stats);
+	bool Write(const std::string& filename, const std::vector<std::string>& entries);
+	void PrintStats(const std::string& name, const Stats& stats, std::ostream& out);
+};
\ No newline at end of file
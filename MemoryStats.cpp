@@ -0,0 +1,122 @@
+#include "MemoryStats.h"
+
+#include<cstdlib>
+#include<new>
+
+//every thread counts into its own copy so worker threads never contend on these
+static thread_local MemoryStats::FrameCounters t_total;
+static thread_local MemoryStats::FrameCounters t_frameStart;
+static thread_local MemoryStats::FrameCounters t_lastFrame;
+
+void* operator new(std::size_t size)
+{
+	t_total.allocations++;
+	t_total.bytesAllocated += size;
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+	if (!p) return;
+	t_total.frees++;
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	operator delete(p);
+}
+
+void MemoryStats::EndFrame()
+{
+	t_lastFrame.allocations = t_total.allocations - t_frameStart.allocations;
+	t_lastFrame.frees = t_total.frees - t_frameStart.frees;
+	t_lastFrame.bytesAllocated = t_total.bytesAllocated - t_frameStart.bytesAllocated;
+	t_frameStart = t_total;
+}
+
+MemoryStats::FrameCounters MemoryStats::LastFrame()
+{
+	return t_lastFrame;
+}
+
+//the control block of a shared_ptr made from a raw pointer, roughly
+static const size_t CONTROL_BLOCK_SIZE = 3 * sizeof(void*);
+
+template<typename T>
+static void countComponent(EntityManager& entities, const char* name, MemoryStats::Report& report)
+{
+	MemoryStats::Report::Component c;
+	c.name = name;
+	c.size = sizeof(T);
+	for (auto& e : entities.getEntities())
+	{
+		if (e->hasComponent<T>()) c.used++;
+		else c.unused++;
+	}
+	report.components.push_back(c);
+}
+
+MemoryStats::Report MemoryStats::Build(EntityManager& entities, const Assets& assets)
+{
+	Report report;
+	report.lastFrame = t_lastFrame;
+
+	//every Entity embeds the full ComponentTuple, so unused components still cost their size
+	static_assert(std::tuple_size<ComponentTuple>::value == 8, "add new components to the memory report");
+	countComponent<CTransform>(entities, "CTransform", report);
+	countComponent<CLifespan>(entities, "CLifespan", report);
+	countComponent<CInput>(entities, "CInput", report);
+	countComponent<CBoundingBox>(entities, "CBoundingBox", report);
+	countComponent<CAnimation>(entities, "CAnimation", report);
+	countComponent<CGravity>(entities, "CGravity", report);
+	countComponent<CState>(entities, "CState", report);
+	countComponent<CBehaviour>(entities, "CBehaviour", report);
+
+	report.entityBytes = entities.getEntities().size() * (sizeof(Entity) + CONTROL_BLOCK_SIZE)
+		+ entities.getEntities().capacity() * sizeof(std::shared_ptr<Entity>);
+
+	for (auto& p : entities.getEntityMap())
+	{
+		Report::Group g;
+		g.name = p.first;
+		g.count = p.second.size();
+		g.bytes = p.second.size() * (sizeof(Entity) + CONTROL_BLOCK_SIZE) + p.second.capacity() * sizeof(std::shared_ptr<Entity>);
+		report.tags.push_back(g);
+	}
+
+	//a level may be loading on another thread, so the asset side is summed under the assets' own lock
+	auto usage = assets.memoryUsage();
+	report.textureGpuBytes += usage.textureGpuBytes;
+	report.assets.push_back({ "Textures", usage.textures.count, usage.textures.bytes });
+	report.assets.push_back({ "Animations", usage.animations.count, usage.animations.bytes });
+	report.assets.push_back({ "Fonts", usage.fonts.count, usage.fonts.bytes });
+	report.assets.push_back({ "Sounds", usage.sounds.count, usage.sounds.bytes });
+
+	return report;
+}
+
+void MemoryStats::Report::print(std::ostream& out) const
+{
+	out << "---- memory report ----\n";
+	out << "components (size / used / unused / bytes):\n";
+	size_t componentBytes = 0, wastedBytes = 0;
+	for (auto& c : components)
+	{
+		out << "  " << c.name << " " << c.size << " / " << c.used << " / " << c.unused << " / " << c.size * (c.used + c.unused) << "\n";
+		componentBytes += c.size * (c.used + c.unused);
+		wastedBytes += c.size * c.unused;
+	}
+	out << "  total " << componentBytes << " bytes, " << wastedBytes << " in unused components\n";
+
+	out << "entities: " << entityBytes << " bytes\n";
+	for (auto& t : tags) out << "  " << t.name << " " << t.count << " entities, " << t.bytes << " bytes\n";
+
+	out << "assets:\n";
+	for (auto& a : assets) out << "  " << a.name << " " << a.count << ", " << a.bytes << " bytes\n";
+	out << "  texture memory on gpu " << textureGpuBytes << " bytes\n";
+
+	out << "last frame: " << lastFrame.allocations << " allocations, " << lastFrame.frees << " frees, "
+		<< lastFrame.bytesAllocated << " bytes allocated\n";
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "EntityManager.h"
+#include "Assets.h"
+
+#include<ostream>
+
+//counts what the process allocates and reports how much a loaded level costs
+namespace MemoryStats
+{
+	//heap traffic seen by one thread between two EndFrame calls
+	struct FrameCounters
+	{
+		size_t allocations = 0;
+		size_t frees = 0;
+		size_t bytesAllocated = 0;
+	};
+
+	struct Report
+	{
+		struct Component
+		{
+			std::string name;
+			size_t size = 0;	//sizeof the component, paid by every entity
+			size_t used = 0;	//entities that have it
+			size_t unused = 0;	//entities that carry it without using it
+		};
+
+		struct Group
+		{
+			std::string name;
+			size_t count = 0;
+			size_t bytes = 0;
+		};
+
+		std::vector<Component> components;
+		std::vector<Group> tags;
+		std::vector<Group> assets;
+		size_t entityBytes = 0;
+		size_t textureGpuBytes = 0;
+		FrameCounters lastFrame;
+
+		void print(std::ostream& out) const;
+	};
+
+	void EndFrame();
+	FrameCounters LastFrame();
+
+	Report Build(EntityManager& entities, const Assets& assets);
+};
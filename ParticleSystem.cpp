@@ -0,0 +1,115 @@
+#include "ParticleSystem.h"
+
+ParticleSystem::ParticleSystem()
+{
+	for (auto v : { &m_x, &m_y, &m_vx, &m_vy, &m_gravity, &m_u, &m_v, &m_width, &m_height }) v->resize(CAPACITY);
+	for (auto v : { &m_age, &m_lifetime, &m_frameCount, &m_frameSpeed }) v->resize(CAPACITY);
+	m_texture.resize(CAPACITY);
+}
+
+uint8_t ParticleSystem::textureIndex(const sf::Texture* texture)
+{
+	for (size_t i = 0; i < m_batches.size(); i++)
+	{
+		if (m_batches[i].texture == texture) return (uint8_t)i;
+	}
+	m_batches.push_back(Batch());
+	m_batches.back().texture = texture;
+	return (uint8_t)(m_batches.size() - 1);
+}
+
+void ParticleSystem::emit(const sf::Texture& texture, const sf::IntRect& rect, size_t frameCount, size_t frameSpeed, size_t lifetime,
+	const Vec2& pos, const Vec2& velocity, float gravity)
+{
+	size_t i = m_next;
+	m_next = (m_next + 1) % CAPACITY;
+	if (m_used < CAPACITY) m_used++;
+
+	m_x[i] = pos.x;				m_y[i] = pos.y;
+	m_vx[i] = velocity.x;		m_vy[i] = velocity.y;
+	m_gravity[i] = gravity;
+	m_u[i] = (float)rect.left;	m_v[i] = (float)rect.top;
+	m_width[i] = (float)rect.width;	m_height[i] = (float)rect.height;
+	m_age[i] = 0;
+	m_lifetime[i] = (uint16_t)lifetime;
+	m_frameCount[i] = (uint16_t)std::max<size_t>(frameCount, 1);
+	m_frameSpeed[i] = (uint16_t)std::max<size_t>(frameSpeed, 1);
+	m_texture[i] = textureIndex(&texture);
+}
+
+//plays an animation once in place, like the explosion entities used to
+void ParticleSystem::emitAnimation(const Animation& animation, const Vec2& pos)
+{
+	auto& sprite = animation.getSprite();
+	sf::IntRect rect(0, 0, (int)animation.getSize().x, (int)animation.getSize().y);
+	emit(*sprite.getTexture(), rect, animation.getFrameCount(), animation.getSpeed(),
+		animation.getFrameCount() * std::max<size_t>(animation.getSpeed(), 1), pos, Vec2(0, 0), 0);
+}
+
+//breaks the current frame of a sprite into four quarters that get thrown up and fall away
+void ParticleSystem::emitDebris(const Animation& source, const Vec2& pos)
+{
+	auto& sprite = source.getSprite();
+	const sf::IntRect& frame = sprite.getTextureRect();
+	int w = frame.width / 2, h = frame.height / 2;
+
+	for (int j = 0; j < 2; j++)
+	{
+		for (int i = 0; i < 2; i++)
+		{
+			sf::IntRect rect(frame.left + i * w, frame.top + j * h, w, h);
+			Vec2 offset((i - 0.5f) * w, (j - 0.5f) * h);
+			Vec2 velocity(i ? 3.f : -3.f, j ? -6.f : -9.f);
+			emit(*sprite.getTexture(), rect, 1, 1, 60, pos + offset, velocity, 0.5f);
+		}
+	}
+}
+
+//one pass over every slot, dead particles are cheaper to advance than to branch around
+void ParticleSystem::update()
+{
+	for (size_t i = 0; i < m_used; i++)
+	{
+		//stops at the lifetime so a slot that is never reused can't wrap around and come back to life
+		if (m_age[i] < m_lifetime[i]) m_age[i]++;
+		m_vy[i] += m_gravity[i];
+		m_x[i] += m_vx[i];
+		m_y[i] += m_vy[i];
+	}
+
+	for (auto& b : m_batches) b.vertices.clear();
+	for (size_t i = 0; i < m_used; i++)
+	{
+		if (m_age[i] >= m_lifetime[i]) continue;
+
+		float u = m_u[i] + (m_age[i] / m_frameSpeed[i] % m_frameCount[i]) * m_width[i];
+		float v = m_v[i];
+		float hw = m_width[i] / 2.f, hh = m_height[i] / 2.f;
+		float left = m_x[i] - hw, right = m_x[i] + hw, top = m_y[i] - hh, bottom = m_y[i] + hh;
+
+		auto& vertices = m_batches[m_texture[i]].vertices;
+		vertices.push_back(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(u, v)));
+		vertices.push_back(sf::Vertex(sf::Vector2f(right, top), sf::Vector2f(u + m_width[i], v)));
+		vertices.push_back(sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(u + m_width[i], v + m_height[i])));
+		vertices.push_back(sf::Vertex(sf::Vector2f(left, bottom), sf::Vector2f(u, v + m_height[i])));
+	}
+}
+
+void ParticleSystem::clear()
+{
+	m_next = 0;
+	m_used = 0;
+	for (auto& b : m_batches) b.vertices.clear();
+}
+
+const std::vector<ParticleSystem::Batch>& ParticleSystem::batches() const
+{
+	return m_batches;
+}
+
+size_t ParticleSystem::bytesUsed() const
+{
+	size_t bytes = CAPACITY * (9 * sizeof(float) + 4 * sizeof(uint16_t) + sizeof(uint8_t));
+	for (auto& b : m_batches) bytes += b.vertices.capacity() * sizeof(sf::Vertex);
+	return bytes;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Animation.h"
+
+#include<SFML/Graphics.hpp>
+#include<vector>
+#include<cstdint>
+
+//short lived cosmetic sprites (explosions, debris) kept out of the EntityManager
+//one array per field in a fixed size ring, the oldest particle is overwritten when it is full
+class ParticleSystem
+{
+public:
+
+	//quads for every live particle sharing one texture, drawn in a single call
+	struct Batch
+	{
+		const sf::Texture* texture = nullptr;
+		std::vector<sf::Vertex> vertices;
+	};
+
+private:
+
+	static const size_t CAPACITY = 4096;
+
+	std::vector<float> m_x, m_y, m_vx, m_vy, m_gravity;
+	std::vector<float> m_u, m_v, m_width, m_height;	//texture rect of the first frame
+	std::vector<uint16_t> m_age, m_lifetime, m_frameCount, m_frameSpeed;
+	std::vector<uint8_t> m_texture;						//index into m_batches
+
+	size_t m_next = 0;	//ring slot the next particle goes in
+	size_t m_used = 0;	//slots that have ever held a particle
+	std::vector<Batch> m_batches;
+
+	uint8_t textureIndex(const sf::Texture* texture);
+
+public:
+
+	ParticleSystem();
+
+	void emit(const sf::Texture& texture, const sf::IntRect& rect, size_t frameCount, size_t frameSpeed, size_t lifetime,
+		const Vec2& pos, const Vec2& velocity, float gravity);
+	void emitAnimation(const Animation& animation, const Vec2& pos);
+	void emitDebris(const Animation& source, const Vec2& pos);
+
+	void update();
+	void clear();
+
+	const std::vector<Batch>& batches() const;
+	size_t bytesUsed() const;
+};
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "Physics.h"
 
+#include<algorithm>
+#include<cmath>
+#include<limits>
+
 Vec2 Physics::GetOverlap(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b) 
 {
 	if(!a->hasComponent<CBoundingBox>() || !b->hasComponent<CBoundingBox>()) return Vec2(0.f, 0.f);
@@ -34,4 +38,177 @@ Vec2 Physics::GetPreviousOverlap(std::shared_ptr<Entity>a, std::shared_ptr<Entit
 	if (horiOverlap < 0) horiOverlap = 0;
 	if (vertOverlap < 0) vertOverlap = 0;
     return Vec2(horiOverlap, vertOverlap);
-}
\ No newline at end of file
+}
+
+//continuous test of a moving from prevPos to pos against b moving the same way
+//works in b's frame: a's box is shrunk to a point and b's box grown by a's half size,
+//then the segment a travelled is clipped against that box one axis at a time
+Physics::Sweep Physics::SweptAABB(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b)
+{
+	Sweep sweep;
+	if (!a->hasComponent<CBoundingBox>() || !b->hasComponent<CBoundingBox>()) return sweep;
+
+	auto& ta = a->getComponent<CTransform>();
+	auto& tb = b->getComponent<CTransform>();
+
+	Vec2 start = ta.prevPos - tb.prevPos;
+	Vec2 delta = (ta.pos - ta.prevPos) - (tb.pos - tb.prevPos);
+	Vec2 extent = a->getComponent<CBoundingBox>().halfSize + b->getComponent<CBoundingBox>().halfSize;
+
+	const float inf = std::numeric_limits<float>::infinity();
+	float entry[2], exit[2];
+	float s[2] = { start.x, start.y };
+	float d[2] = { delta.x, delta.y };
+	float e[2] = { extent.x, extent.y };
+
+	for (int i = 0; i < 2; i++)
+	{
+		if (d[i] == 0)
+		{
+			//not moving on this axis, so it must already be inside the slab
+			if (std::abs(s[i]) >= e[i]) return sweep;
+			entry[i] = -inf;
+			exit[i] = inf;
+		}
+		else
+		{
+			float t1 = (-e[i] - s[i]) / d[i];
+			float t2 = (e[i] - s[i]) / d[i];
+			entry[i] = std::min(t1, t2);
+			exit[i] = std::max(t1, t2);
+		}
+	}
+
+	float tEntry = std::max(entry[0], entry[1]);
+	float tExit = std::min(exit[0], exit[1]);
+
+	//overlapping at the start is left to the discrete test
+	if (tEntry > tExit || tEntry < 0.f || tEntry > 1.f) return sweep;
+
+	sweep.hit = true;
+	sweep.time = tEntry;
+	if (entry[0] > entry[1]) sweep.normal = Vec2(d[0] > 0 ? -1.f : 1.f, 0.f);
+	else sweep.normal = Vec2(0.f, d[1] > 0 ? -1.f : 1.f);
+	return sweep;
+}
+
+//an entity that moved more than half its box this frame can skip past the discrete test
+bool Physics::IsFast(std::shared_ptr<Entity> e)
+{
+	if (!e->hasComponent<CBoundingBox>()) return false;
+
+	auto& t = e->getComponent<CTransform>();
+	auto& halfSize = e->getComponent<CBoundingBox>().halfSize;
+	return std::abs(t.pos.x - t.prevPos.x) > halfSize.x || std::abs(t.pos.y - t.prevPos.y) > halfSize.y;
+}
+
+Physics::World::World(const Vec2& cellSize)
+	:m_cellSize(cellSize) {}
+
+void Physics::World::setTiles(const EntityVector& tiles)
+{
+	m_columns.clear();
+	for (auto& tile : tiles)
+	{
+		float x = tile->getComponent<CTransform>().pos.x;
+		float halfWidth = tile->getComponent<CBoundingBox>().halfSize.x;
+		int first = (int)std::floor((x - halfWidth) / m_cellSize.x + 0.5f);
+		int last = std::max(first, (int)std::ceil((x + halfWidth) / m_cellSize.x - 0.5f) - 1);
+		for (int column = first; column <= last; column++) m_columns[column].push_back(tile);
+	}
+}
+
+//extra substeps on top of the ones a fast body takes anyway
+void Physics::World::setSubsteps(size_t substeps)
+{
+	m_substeps = std::max<size_t>(substeps, 1);
+}
+
+//the live tiles in the columns a move covers, in id order so every run resolves them the same way
+void Physics::World::gatherTiles(float left, float right)
+{
+	m_nearby.clear();
+	int first = (int)std::floor(left / m_cellSize.x) - 1;
+	int last = (int)std::floor(right / m_cellSize.x) + 1;
+	for (int column = first; column <= last; column++)
+	{
+		auto it = m_columns.find(column);
+		if (it == m_columns.end()) continue;
+		for (auto& tile : it->second) { if (tile->isActive()) m_nearby.push_back(tile); }
+	}
+
+	std::sort(m_nearby.begin(), m_nearby.end(), [](auto& a, auto& b) { return a->id() < b->id(); });
+	m_nearby.erase(std::unique(m_nearby.begin(), m_nearby.end()), m_nearby.end());
+}
+
+//one axis of one substep, pushes the body back out of anything it moved into
+void Physics::World::move(std::shared_ptr<Entity> body, Vec2& pos, const Vec2& halfSize, float delta, bool vertical, uint8_t& contacts)
+{
+	if (delta == 0) return;
+	(vertical ? pos.y : pos.x) += delta;
+
+	for (auto& tile : m_nearby)
+	{
+		auto& tilePos = tile->getComponent<CTransform>().pos;
+		auto& tileHalf = tile->getComponent<CBoundingBox>().halfSize;
+		float overlapX = halfSize.x + tileHalf.x - std::abs(pos.x - tilePos.x);
+		float overlapY = halfSize.y + tileHalf.y - std::abs(pos.y - tilePos.y);
+		if (overlapX <= 0 || overlapY <= 0) continue;
+
+		uint8_t contact;
+		if (vertical)
+		{
+			pos.y += delta > 0 ? -overlapY : overlapY;
+			contact = delta > 0 ? CONTACT_GROUND : CONTACT_CEILING;
+		}
+		else
+		{
+			pos.x += delta > 0 ? -overlapX : overlapX;
+			contact = delta > 0 ? CONTACT_WALL_RIGHT : CONTACT_WALL_LEFT;
+		}
+		contacts |= contact;
+		m_hits.push_back({ body, tile, contact });
+	}
+}
+
+//fast bodies get enough substeps that none moves more than half their size
+void Physics::World::resolve(std::shared_ptr<Entity> body)
+{
+	auto& transform = body->getComponent<CTransform>();
+	auto& halfSize = body->getComponent<CBoundingBox>().halfSize;
+	auto& gravity = body->getComponent<CGravity>();
+
+	Vec2 motion = transform.pos - transform.prevPos;
+	float ratio = std::max(std::abs(motion.x) / std::max(halfSize.x, 1.f), std::abs(motion.y) / std::max(halfSize.y, 1.f));
+	size_t substeps = std::min(std::max(m_substeps, (size_t)std::ceil(ratio)), MAX_SUBSTEPS);
+	Vec2 delta = motion / (float)substeps;
+
+	gatherTiles(std::min(transform.prevPos.x, transform.pos.x) - halfSize.x, std::max(transform.prevPos.x, transform.pos.x) + halfSize.x);
+
+	Vec2 pos = transform.prevPos;
+	uint8_t contacts = 0;
+	for (size_t i = 0; i < substeps; i++)
+	{
+		//an axis that hit something stays put for the rest of the step
+		move(body, pos, halfSize, (contacts & (CONTACT_WALL_LEFT | CONTACT_WALL_RIGHT)) ? 0.f : delta.x, false, contacts);
+		move(body, pos, halfSize, (contacts & (CONTACT_GROUND | CONTACT_CEILING)) ? 0.f : delta.y, true, contacts);
+	}
+
+	transform.pos = pos;
+	if (contacts & (CONTACT_GROUND | CONTACT_CEILING)) transform.velocity.y = 0;
+	gravity.contacts = contacts;
+}
+
+void Physics::World::step(const EntityVector& bodies)
+{
+	m_hits.clear();
+	for (auto& body : bodies)
+	{
+		if (body->isActive()) resolve(body);
+	}
+}
+
+const std::vector<Physics::World::Hit>& Physics::World::hits() const
+{
+	return m_hits;
+}
@@ -1,9 +1,71 @@
 #pragma once
 #include "Vec2.h"
 #include "Entity.h"
+#include "EntityManager.h"
+
+#include<unordered_map>
 
 namespace Physics
 {
+	//result of a swept test, time is the fraction of this frame's motion at first contact
+	struct Sweep
+	{
+		bool hit = false;
+		float time = 1.f;
+		Vec2 normal = { 0.f, 0.f }; //surface normal of b at the contact, pointing towards a
+	};
+
+	//what a body touched in its last step, kept in CGravity::contacts
+	enum Contact : uint8_t
+	{
+		CONTACT_GROUND		= 1 << 0,
+		CONTACT_CEILING		= 1 << 1,
+		CONTACT_WALL_LEFT	= 1 << 2,
+		CONTACT_WALL_RIGHT	= 1 << 3
+	};
+
+	//resolves every body (CGravity + CBoundingBox) against the tiles once sMovement has integrated it
+	//a body retraces its move from prevPos in substeps, x then y, so it can't tunnel through a tile or snag on the seam
+	//between two, landing and ceilings zero its vertical speed, walls are only reported so the owner decides what to do
+	class World
+	{
+	public:
+
+		struct Hit
+		{
+			std::shared_ptr<Entity> body;
+			std::shared_ptr<Entity> tile;
+			uint8_t contact;
+		};
+
+	private:
+
+		static const size_t MAX_SUBSTEPS = 16;
+
+		Vec2 m_cellSize;
+		size_t m_substeps = 1;
+		std::unordered_map<int, EntityVector> m_columns;	//tiles by column, a wide tile is in every column it covers
+		std::vector<Hit> m_hits;
+		EntityVector m_nearby;
+
+		void gatherTiles(float left, float right);
+		void move(std::shared_ptr<Entity> body, Vec2& pos, const Vec2& halfSize, float delta, bool vertical, uint8_t& contacts);
+
+	public:
+
+		World(const Vec2& cellSize = Vec2(64, 64));
+
+		void setTiles(const EntityVector& tiles);
+		void setSubsteps(size_t substeps);
+
+		void step(const EntityVector& bodies);
+		void resolve(std::shared_ptr<Entity> body);
+
+		const std::vector<Hit>& hits() const;	//from the last step and any resolves since
+	};
+
 	Vec2 GetOverlap(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b);
 	Vec2 GetPreviousOverlap(std::shared_ptr<Entity>a, std::shared_ptr<Entity>b);
-};
\ No newline at end of file
+	Sweep SweptAABB(std::shared_ptr<Entity> a, std::shared_ptr<Entity> b);
+	bool IsFast(std::shared_ptr<Entity> e);
+};
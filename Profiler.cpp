@@ -0,0 +1,60 @@
+#include "Profiler.h"
+
+#include<algorithm>
+
+std::vector<float>& Profiler::samples(const char* system)
+{
+	for (auto& s : m_samples)
+	{
+		if (s.first == system) return s.second;
+	}
+	m_samples.push_back({ system, {} });
+	return m_samples.back().second;
+}
+
+void Profiler::clear()
+{
+	m_samples.clear();
+}
+
+//nearest rank percentiles
+std::vector<Profiler::Summary> Profiler::summarize() const
+{
+	std::vector<Summary> summaries;
+	for (auto& s : m_samples)
+	{
+		if (s.second.empty()) continue;
+
+		std::vector<float> sorted = s.second;
+		std::sort(sorted.begin(), sorted.end());
+
+		Summary summary;
+		summary.system = s.first;
+		summary.p50 = sorted[(sorted.size() - 1) * 50 / 100];
+		summary.p99 = sorted[(sorted.size() - 1) * 99 / 100];
+		summary.max = sorted.back();
+		summaries.push_back(summary);
+	}
+	return summaries;
+}
+
+Profiler::Timer::Timer(Profiler* profiler)
+	:m_profiler(profiler)
+{
+	if (m_profiler) m_start = m_last = Clock::now();
+}
+
+Profiler::Timer::~Timer()
+{
+	if (!m_profiler) return;
+	m_profiler->samples("Frame").push_back(std::chrono::duration<float, std::micro>(Clock::now() - m_start).count());
+}
+
+void Profiler::Timer::lap(const char* system)
+{
+	if (!m_profiler) return;
+
+	auto now = Clock::now();
+	m_profiler->samples(system).push_back(std::chrono::duration<float, std::micro>(now - m_last).count());
+	m_last = now;
+}
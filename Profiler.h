@@ -0,0 +1,40 @@
+#pragma once
+
+#include<chrono>
+#include<string>
+#include<vector>
+
+//how long each system took, frame by frame, while a Profiler is attached to a Scene_Play
+class Profiler
+{
+	typedef std::chrono::steady_clock Clock;
+
+	std::vector<std::pair<std::string, std::vector<float>>> m_samples;	//per system in the order they first ran, microseconds
+
+	std::vector<float>& samples(const char* system);
+
+public:
+
+	struct Summary
+	{
+		std::string system;
+		float p50 = 0, p99 = 0, max = 0;	//microseconds
+	};
+
+	//splits one frame into consecutive stretches, does nothing for a null profiler
+	class Timer
+	{
+		Profiler* m_profiler;
+		Clock::time_point m_start, m_last;
+
+	public:
+
+		Timer(Profiler* profiler);
+		~Timer();	//records the whole frame as "Frame"
+
+		void lap(const char* system);
+	};
+
+	void clear();
+	std::vector<Summary> summarize() const;
+};
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "RenderStats.h"
+
+#include<algorithm>
+#include<iostream>
+
+RenderStats::RenderStats(sf::RenderWindow& window)
+	:m_target(window), m_window(&window) {}
+
+RenderStats::RenderStats(sf::RenderTexture& texture)
+	:m_target(texture), m_texture(&texture) {}
+
+sf::RenderTarget& RenderStats::target()
+{
+	return m_target;
+}
+
+void RenderStats::count(const sf::RenderStates& states, size_t vertices)
+{
+	m_frame.drawCalls++;
+	m_frame.vertices += vertices;
+
+	if (m_first || states.texture != m_boundTexture) m_frame.textureChanges++;
+	if (m_first || states.blendMode != m_blendMode || states.shader != m_shader) m_frame.stateChanges++;
+
+	m_first = false;
+	m_boundTexture = states.texture;
+	m_blendMode = states.blendMode;
+	m_shader = states.shader;
+}
+
+void RenderStats::draw(const sf::Sprite& sprite, const sf::RenderStates& states)
+{
+	sf::RenderStates used = states;
+	used.texture = sprite.getTexture();
+	count(used, 4);
+	m_target.draw(sprite, states);
+}
+
+//sfml builds text from two triangles per glyph
+void RenderStats::draw(const sf::Text& text, const sf::RenderStates& states)
+{
+	sf::RenderStates used = states;
+	if (text.getFont()) used.texture = &text.getFont()->getTexture(text.getCharacterSize());
+	count(used, text.getString().getSize() * 6);
+	m_target.draw(text, states);
+}
+
+//a fan for the fill, a strip around it for the outline
+void RenderStats::draw(const sf::Shape& shape, const sf::RenderStates& states)
+{
+	sf::RenderStates used = states;
+	used.texture = shape.getTexture();
+	size_t points = shape.getPointCount();
+	count(used, points + 2);
+	if (shape.getOutlineThickness() != 0)
+	{
+		count(sf::RenderStates(states.blendMode), (points + 1) * 2);
+	}
+	m_target.draw(shape, states);
+}
+
+void RenderStats::draw(const sf::VertexArray& vertices, const sf::RenderStates& states)
+{
+	count(states, vertices.getVertexCount());
+	m_target.draw(vertices, states);
+}
+
+void RenderStats::draw(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states)
+{
+	this->count(states, count);
+	m_target.draw(vertices, count, type, states);
+}
+
+void RenderStats::addEntities(size_t drawn, size_t culled)
+{
+	m_frame.drawn += drawn;
+	m_frame.culled += culled;
+}
+
+void RenderStats::display()
+{
+	if (m_window) m_window->display();
+	if (m_texture) m_texture->display();
+
+	if (m_log)
+	{
+		m_log << m_frames << "," << m_frame.drawCalls << "," << m_frame.textureChanges << "," << m_frame.stateChanges << ","
+			<< m_frame.vertices << "," << m_frame.drawn << "," << m_frame.culled << "\n";
+	}
+
+	m_worst.drawCalls = std::max(m_worst.drawCalls, m_frame.drawCalls);
+	m_worst.textureChanges = std::max(m_worst.textureChanges, m_frame.textureChanges);
+	m_worst.stateChanges = std::max(m_worst.stateChanges, m_frame.stateChanges);
+	m_worst.vertices = std::max(m_worst.vertices, m_frame.vertices);
+	m_worst.drawn = std::max(m_worst.drawn, m_frame.drawn);
+	m_worst.culled = std::max(m_worst.culled, m_frame.culled);
+
+	m_last = m_frame;
+	m_frame = Counters();
+	m_first = true;
+	m_frames++;
+}
+
+bool RenderStats::openLog(const std::string& path)
+{
+	m_log.open(path);
+	if (!m_log)
+	{
+		std::cerr << "Couldn't open render stats log: " << path << "\n";
+		return false;
+	}
+	m_log << "frame,draw_calls,texture_changes,state_changes,vertices,drawn,culled\n";
+	return true;
+}
+
+const RenderStats::Counters& RenderStats::lastFrame() const
+{
+	return m_last;
+}
+
+const RenderStats::Counters& RenderStats::worstFrame() const
+{
+	return m_worst;
+}
+
+size_t RenderStats::frames() const
+{
+	return m_frames;
+}
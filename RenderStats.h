@@ -0,0 +1,67 @@
+#pragma once
+
+#include<SFML/Graphics.hpp>
+#include<fstream>
+#include<string>
+
+//every draw a scene issues from sRender goes through here, so whether a rendering change helped can be read off
+//wraps a window or an offscreen texture, the latter lets a run without a window check draw call budgets
+class RenderStats
+{
+public:
+
+	struct Counters
+	{
+		size_t drawCalls = 0;
+		size_t textureChanges = 0;	//draws whose texture differs from the draw before
+		size_t stateChanges = 0;	//draws whose blend mode or shader differs from the draw before
+		size_t vertices = 0;
+		size_t drawn = 0;			//entities on screen
+		size_t culled = 0;			//entities skipped because they were off screen
+	};
+
+private:
+
+	sf::RenderTarget& m_target;
+	sf::RenderWindow* m_window = nullptr;
+	sf::RenderTexture* m_texture = nullptr;
+
+	Counters m_frame;
+	Counters m_last;
+	Counters m_worst;
+	size_t m_frames = 0;
+
+	bool m_first = true;	//nothing drawn yet this frame, the next draw sets every state
+	const sf::Texture* m_boundTexture = nullptr;
+	sf::BlendMode m_blendMode;
+	const sf::Shader* m_shader = nullptr;
+
+	std::ofstream m_log;
+
+	void count(const sf::RenderStates& states, size_t vertices);
+
+public:
+
+	RenderStats(sf::RenderWindow& window);
+	RenderStats(sf::RenderTexture& texture);
+
+	//for clearing and views, drawing straight to it bypasses the counters
+	sf::RenderTarget& target();
+
+	void draw(const sf::Sprite& sprite, const sf::RenderStates& states = sf::RenderStates::Default);
+	void draw(const sf::Text& text, const sf::RenderStates& states = sf::RenderStates::Default);
+	void draw(const sf::Shape& shape, const sf::RenderStates& states = sf::RenderStates::Default);
+	void draw(const sf::VertexArray& vertices, const sf::RenderStates& states = sf::RenderStates::Default);
+	void draw(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states = sf::RenderStates::Default);
+	void addEntities(size_t drawn, size_t culled);
+
+	//presents the frame and closes its counters
+	void display();
+
+	//one csv row per frame from now on
+	bool openLog(const std::string& path);
+
+	const Counters& lastFrame() const;
+	const Counters& worstFrame() const;	//largest of each counter on its own, not one real frame
+	size_t frames() const;
+};
\ No newline at end of file
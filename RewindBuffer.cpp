@@ -0,0 +1,192 @@
+#include "RewindBuffer.h"
+
+#include<cstring>
+
+RewindBuffer::RewindBuffer()
+	:RewindBuffer(600)
+{}
+
+RewindBuffer::RewindBuffer(size_t capacity)
+	:m_frames(capacity)
+{}
+
+RewindBuffer::Frame& RewindBuffer::slot(size_t frame)
+{
+	return m_frames[frame % m_frames.size()];
+}
+
+const RewindBuffer::Frame& RewindBuffer::slot(size_t frame) const
+{
+	return m_frames[frame % m_frames.size()];
+}
+
+//records are sorted by id, so a single merge pass finds what changed, appeared or went away
+void RewindBuffer::encodeDelta(const WorldState& state, Frame& out) const
+{
+	auto& prev = m_last.entities;
+	auto& curr = state.entities;
+	size_t i = 0, j = 0;
+
+	while (i < prev.size() || j < curr.size())
+	{
+		if (j == curr.size() || (i < prev.size() && prev[i].id < curr[j].id))
+		{
+			out.removed.push_back(prev[i].id);
+			i++;
+		}
+		else if (i == prev.size() || curr[j].id < prev[i].id)
+		{
+			out.records.push_back(curr[j]);
+			j++;
+		}
+		else
+		{
+			if (std::memcmp(&prev[i], &curr[j], sizeof(EntityRecord)) != 0) out.records.push_back(curr[j]);
+			i++;
+			j++;
+		}
+	}
+}
+
+void RewindBuffer::applyDelta(const Frame& delta, WorldState& state)
+{
+	static thread_local std::vector<EntityRecord> merged;
+	merged.clear();
+
+	auto& prev = state.entities;
+	size_t i = 0, r = 0, d = 0;
+
+	while (i < prev.size() || d < delta.records.size())
+	{
+		//drop records this frame removed
+		if (i < prev.size() && r < delta.removed.size() && prev[i].id == delta.removed[r])
+		{
+			i++;
+			r++;
+		}
+		else if (d == delta.records.size() || (i < prev.size() && prev[i].id < delta.records[d].id))
+		{
+			merged.push_back(prev[i++]);
+		}
+		else if (i == prev.size() || delta.records[d].id < prev[i].id)
+		{
+			merged.push_back(delta.records[d++]);
+		}
+		else
+		{
+			merged.push_back(delta.records[d++]);
+			i++;
+		}
+	}
+
+	state.entities.swap(merged);
+	state.frame = delta.frame;
+	state.lives = delta.lives;
+	state.totalEntities = delta.totalEntities;
+}
+
+void RewindBuffer::push(const WorldState& state)
+{
+	//anything but the next frame in sequence starts a fresh history
+	if (m_count > 0 && state.frame != m_newest + 1) clear();
+
+	Frame& f = slot(state.frame);
+	f.frame = state.frame;
+	f.lives = state.lives;
+	f.totalEntities = state.totalEntities;
+	f.records.clear();
+	f.removed.clear();
+	f.keyframe = (m_count == 0 || state.frame % KEYFRAME_INTERVAL == 0);
+
+	if (f.keyframe) f.records = state.entities;
+	else encodeDelta(state, f);
+
+	m_last.frame = state.frame;
+	m_last.lives = state.lives;
+	m_last.totalEntities = state.totalEntities;
+	m_last.entities = state.entities;
+
+	m_newest = state.frame;
+	if (m_count < m_frames.size()) m_count++;
+}
+
+//walks back to the nearest keyframe and replays the deltas up to the requested frame
+//frames after it are dropped, so the next push continues from the restored state
+bool RewindBuffer::restore(size_t frame, WorldState& state)
+{
+	if (!contains(frame)) return false;
+
+	size_t key = frame;
+	while (!slot(key).keyframe) key--;
+
+	const Frame& k = slot(key);
+	state.frame = k.frame;
+	state.lives = k.lives;
+	state.totalEntities = k.totalEntities;
+	state.entities = k.records;
+
+	for (size_t f = key + 1; f <= frame; f++) applyDelta(slot(f), state);
+
+	m_count -= (m_newest - frame);
+	m_newest = frame;
+	m_last = state;
+	return true;
+}
+
+void RewindBuffer::clear()
+{
+	m_count = 0;
+	m_newest = 0;
+	m_last.entities.clear();
+}
+
+//a frame is only usable if the keyframe it depends on has not been overwritten yet
+bool RewindBuffer::contains(size_t frame) const
+{
+	return m_count > 0 && frame <= m_newest && frame >= oldestFrame();
+}
+
+size_t RewindBuffer::oldestFrame() const
+{
+	if (m_count == 0) return 0;
+
+	size_t oldest = m_newest + 1 - m_count;
+	while (oldest < m_newest && !slot(oldest).keyframe) oldest++;
+	return oldest;
+}
+
+size_t RewindBuffer::newestFrame() const
+{
+	return m_newest;
+}
+
+size_t RewindBuffer::frameCount() const
+{
+	return m_count;
+}
+
+size_t RewindBuffer::bytesUsed() const
+{
+	size_t bytes = 0;
+	for (auto& f : m_frames)
+	{
+		bytes += sizeof(Frame) + f.records.capacity() * sizeof(EntityRecord) + f.removed.capacity() * sizeof(uint32_t);
+	}
+	return bytes + m_last.entities.capacity() * sizeof(EntityRecord);
+}
+
+void RewindBuffer::recordPushTime(float micros)
+{
+	m_lastPushMicros = micros;
+	m_averagePushMicros = m_averagePushMicros * 0.95f + micros * 0.05f;
+}
+
+float RewindBuffer::lastPushMicros() const
+{
+	return m_lastPushMicros;
+}
+
+float RewindBuffer::averagePushMicros() const
+{
+	return m_averagePushMicros;
+}
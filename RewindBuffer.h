@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Snapshot.h"
+
+//ring of the last N frames of world state
+//every KEYFRAME_INTERVAL frames a full copy is kept, frames in between only store
+//the records that changed since the frame before them plus the ids that went away
+class RewindBuffer
+{
+	static const size_t KEYFRAME_INTERVAL = 30;
+
+	struct Frame
+	{
+		size_t frame = 0;
+		bool keyframe = false;
+		int lives = 0;
+		size_t totalEntities = 0;
+		std::vector<EntityRecord> records;	//full state on keyframes, changed or new records otherwise
+		std::vector<uint32_t> removed;		//ids present in the previous frame but not this one
+	};
+
+	std::vector<Frame> m_frames;
+	size_t m_count = 0;		//frames currently stored
+	size_t m_newest = 0;	//frame number of the most recent push
+	WorldState m_last;		//decoded newest frame, deltas are taken against it
+
+	//capture cost, so it can be checked against the frame budget
+	float m_lastPushMicros = 0;
+	float m_averagePushMicros = 0;
+
+	Frame& slot(size_t frame);
+	const Frame& slot(size_t frame) const;
+	void encodeDelta(const WorldState& state, Frame& out) const;
+	static void applyDelta(const Frame& delta, WorldState& state);
+
+public:
+
+	RewindBuffer();
+	RewindBuffer(size_t capacity);
+
+	void push(const WorldState& state);
+	bool restore(size_t frame, WorldState& state);
+	void clear();
+
+	bool contains(size_t frame) const;
+	size_t oldestFrame() const;
+	size_t newestFrame() const;
+	size_t frameCount() const;
+	size_t bytesUsed() const;
+
+	void recordPushTime(float micros);
+	float lastPushMicros() const;
+	float averagePushMicros() const;
+};
@@ -0,0 +1,186 @@
+#include "Rollback.h"
+#include "Scene_Play.h"
+
+RollbackSession::RollbackSession(Scene_Play& world, size_t localPlayer, unsigned short localPort, const std::string& remoteAddress, unsigned short remotePort)
+	:m_world(world)
+	, m_localPlayer(localPlayer)
+	, m_remotePlayer(1 - localPlayer)
+	, m_remoteAddress(remoteAddress)
+	, m_remotePort(remotePort)
+{
+	if (m_socket.bind(localPort) != sf::Socket::Done)
+	{
+		std::cerr << "Couldn't bind netplay socket to port " << localPort << "\n";
+	}
+	m_socket.setBlocking(false);
+
+	for (auto& m : m_usedRemote) m = 0;
+}
+
+//confirmed input if it has arrived, otherwise the last confirmed one
+uint8_t RollbackSession::remoteInput(size_t frame) const
+{
+	auto& in = m_remoteInputs[frame % HISTORY];
+	if (in.confirmed && in.frame == frame) return in.mask;
+	if (m_remoteConfirmed == 0) return 0;
+	return m_remoteInputs[(m_remoteConfirmed - 1) % HISTORY].mask;
+}
+
+void RollbackSession::simulate(size_t frame)
+{
+	m_world.captureState(m_states[frame % STATE_RING]);
+
+	uint8_t remote = remoteInput(frame);
+	m_usedRemote[frame % HISTORY] = remote;
+	m_world.setInputMask(m_localPlayer, m_localInputs[frame % HISTORY].mask);
+	m_world.setInputMask(m_remotePlayer, remote);
+	m_world.step();
+}
+
+//packet: ack, first frame, count, then one mask per frame
+void RollbackSession::receive()
+{
+	sf::Packet packet;
+	sf::IpAddress sender;
+	unsigned short port;
+
+	while (m_socket.receive(packet, sender, port) == sf::Socket::Done)
+	{
+		sf::Uint32 ack, first;
+		sf::Uint8 count;
+		if (!(packet >> ack >> first >> count)) continue;
+
+		m_remoteAck = std::max(m_remoteAck, (size_t)ack);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			sf::Uint8 mask;
+			if (!(packet >> mask)) break;
+
+			size_t f = first + i;
+			if (f < m_remoteConfirmed || f >= m_remoteConfirmed + HISTORY - MAX_INPUTS_PER_PACKET) continue;
+			m_remoteInputs[f % HISTORY] = { f, mask, true };
+		}
+
+		while (m_remoteInputs[m_remoteConfirmed % HISTORY].confirmed && m_remoteInputs[m_remoteConfirmed % HISTORY].frame == m_remoteConfirmed)
+		{
+			m_remoteConfirmed++;
+		}
+	}
+}
+
+//finds the first simulated frame whose remote input no longer matches what it ran with,
+//restores the world to that frame and re-simulates everything since
+void RollbackSession::rollback(size_t checkFrom)
+{
+	size_t from = m_frame;
+	for (size_t f = checkFrom; f < m_frame; f++)
+	{
+		if (remoteInput(f) != m_usedRemote[f % HISTORY]) { from = f; break; }
+	}
+	if (from == m_frame) return;
+
+	sf::Clock clock;
+	m_world.setSilent(true);
+	m_world.restoreState(m_states[from % STATE_RING]);
+	for (size_t f = from; f < m_frame; f++) simulate(f);
+	m_world.setSilent(false);
+
+	m_rollbacks++;
+	m_resimulatedFrames += m_frame - from;
+	m_maxRollbackMicros = std::max(m_maxRollbackMicros, (float)clock.getElapsedTime().asMicroseconds());
+}
+
+void RollbackSession::send()
+{
+	//everything the peer hasn't confirmed yet, so a lost packet is covered by the next one
+	size_t first = m_remoteAck;
+	size_t count = std::min(m_frame - first, MAX_INPUTS_PER_PACKET);
+
+	PendingPacket pending;
+	pending.sendTick = m_tick + m_latency;
+	pending.packet << (sf::Uint32)m_remoteConfirmed << (sf::Uint32)first << (sf::Uint8)count;
+	for (size_t f = first; f < first + count; f++) pending.packet << (sf::Uint8)m_localInputs[f % HISTORY].mask;
+
+	if (m_loss > 0.f && std::uniform_real_distribution<float>(0.f, 1.f)(m_random) < m_loss) return;
+	m_outgoing.push_back(pending);
+}
+
+void RollbackSession::flush()
+{
+	while (!m_outgoing.empty() && m_outgoing.front().sendTick <= m_tick)
+	{
+		m_socket.send(m_outgoing.front().packet, m_remoteAddress, m_remotePort);
+		m_outgoing.pop_front();
+	}
+}
+
+//simulates one frame with the given local input, returns false if we are too far
+//ahead of the peer and have to wait for its inputs
+bool RollbackSession::advance(uint8_t localInput)
+{
+	m_tick++;
+	size_t checkFrom = m_remoteConfirmed;
+	receive();
+	rollback(checkFrom);
+
+	bool advanced = false;
+	if (m_frame < m_remoteConfirmed + MAX_ROLLBACK)
+	{
+		m_localInputs[m_frame % HISTORY] = { m_frame, localInput, true };
+		simulate(m_frame);
+		m_frame++;
+		advanced = true;
+	}
+	else
+	{
+		m_stalls++;
+	}
+
+	send();
+	flush();
+	return advanced;
+}
+
+//network only: take in remote inputs, fix up the past and keep our inputs flowing
+void RollbackSession::poll()
+{
+	m_tick++;
+	size_t checkFrom = m_remoteConfirmed;
+	receive();
+	rollback(checkFrom);
+	send();
+	flush();
+}
+
+bool RollbackSession::synchronized() const
+{
+	return m_remoteConfirmed >= m_frame;
+}
+
+void RollbackSession::setSimulatedLatency(size_t ticks)
+{
+	m_latency = ticks;
+}
+
+void RollbackSession::setPacketLoss(float probability, unsigned seed)
+{
+	m_loss = probability;
+	m_random.seed(seed);
+}
+
+size_t RollbackSession::frame() const
+{
+	return m_frame;
+}
+
+float RollbackSession::maxRollbackMicros() const
+{
+	return m_maxRollbackMicros;
+}
+
+void RollbackSession::printStats(std::ostream& out) const
+{
+	out << "netplay: frame " << m_frame << ", " << m_rollbacks << " rollbacks, " << m_resimulatedFrames << " frames re-simulated, "
+		<< m_stalls << " stalls, worst rollback " << m_maxRollbackMicros << " us\n";
+}
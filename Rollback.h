@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Snapshot.h"
+
+#include<SFML/Network.hpp>
+#include<deque>
+#include<random>
+
+class Scene_Play;
+
+//two peers each run the full simulation and only exchange input masks over UDP
+//remote input that hasn't arrived yet is predicted as "same as last time", when the real
+//input turns out different the world is restored to that frame and re-simulated up to now
+class RollbackSession
+{
+public:
+	static const size_t MAX_ROLLBACK = 8;	//frames we may run ahead of the last confirmed remote input
+
+private:
+	static const size_t HISTORY = 128;
+	static const size_t STATE_RING = MAX_ROLLBACK + 2;
+	static const size_t MAX_INPUTS_PER_PACKET = 32;
+
+	struct InputFrame
+	{
+		size_t frame = 0;
+		uint8_t mask = 0;
+		bool confirmed = false;
+	};
+
+	struct PendingPacket
+	{
+		size_t sendTick = 0;
+		sf::Packet packet;
+	};
+
+	Scene_Play& m_world;
+	size_t m_localPlayer = 0;
+	size_t m_remotePlayer = 1;
+
+	sf::UdpSocket m_socket;
+	sf::IpAddress m_remoteAddress;
+	unsigned short m_remotePort = 0;
+
+	InputFrame m_localInputs[HISTORY];
+	InputFrame m_remoteInputs[HISTORY];
+	uint8_t m_usedRemote[HISTORY];		//remote mask each simulated frame actually ran with
+	WorldState m_states[STATE_RING];	//world before each of the last few frames
+
+	size_t m_frame = 0;				//next frame to simulate
+	size_t m_remoteConfirmed = 0;	//every remote input before this frame has arrived
+	size_t m_remoteAck = 0;			//every local input before this frame has reached the peer
+
+	//injected network conditions, latency is counted in calls to advance/poll
+	size_t m_tick = 0;
+	size_t m_latency = 0;
+	float m_loss = 0.f;
+	std::mt19937 m_random;
+	std::deque<PendingPacket> m_outgoing;
+
+	size_t m_rollbacks = 0;
+	size_t m_resimulatedFrames = 0;
+	size_t m_stalls = 0;
+	float m_maxRollbackMicros = 0;
+
+	uint8_t remoteInput(size_t frame) const;
+	void simulate(size_t frame);
+	void receive();
+	void rollback(size_t checkFrom);
+	void send();
+	void flush();
+
+public:
+
+	RollbackSession(Scene_Play& world, size_t localPlayer, unsigned short localPort, const std::string& remoteAddress, unsigned short remotePort);
+
+	bool advance(uint8_t localInput);
+	void poll();
+	bool synchronized() const;
+
+	void setSimulatedLatency(size_t ticks);
+	void setPacketLoss(float probability, unsigned seed);
+
+	size_t frame() const;
+	float maxRollbackMicros() const;	//restore plus resimulation, worst seen so far
+	void printStats(std::ostream& out) const;
+};
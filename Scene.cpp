@@ -1,11 +1,38 @@
 #include "Scene.h"
 #include "GameEngine.h"
+#include "MemoryStats.h"
 
 Scene::Scene() {}
 
 Scene::Scene(GameEngine* gameEngine)
 {
 	m_game = gameEngine;
+	m_assets = &gameEngine->assets();
+}
+
+//a scene without a game engine: no window, no audio, only read access to shared assets
+Scene::Scene(const Assets& assets, size_t width, size_t height)
+	:m_assets(&assets)
+	, m_width(width)
+	, m_height(height)
+{}
+
+//runs after the derived scene's sprites and text are gone, so nothing still points at what gets evicted
+Scene::~Scene()
+{
+	if (m_assets) m_assets->release(m_manifest);
+}
+
+//takes a reference on whatever in the manifest this scene doesn't hold yet
+void Scene::acquireAssets(const Assets::Manifest& manifest)
+{
+	Assets::Manifest fresh;
+	for (auto& name : manifest.animations) { if (m_manifest.animations.insert(name).second) fresh.animations.insert(name); }
+	for (auto& name : manifest.fonts) { if (m_manifest.fonts.insert(name).second) fresh.fonts.insert(name); }
+	assets().acquire(fresh);
+
+	for (auto& name : fresh.animations) { if (auto a = assets().animationHandle(name)) m_animations[name] = a; }
+	for (auto& name : fresh.fonts) { if (auto f = assets().fontHandle(name)) m_fonts[name] = f; }
 }
 
 void Scene::setPaused(bool paused)
@@ -13,11 +40,38 @@ void Scene::setPaused(bool paused)
 	m_paused = paused;
 }
 
+void Scene::playSound(const std::string& soundName)
+{
+	if (m_game && !m_silent) m_game->audio().playSound(soundName);
+}
+
+void Scene::setSilent(bool silent)
+{
+	m_silent = silent;
+}
+
 void Scene::doAction(const Action& action)
 {
 	sDoAction(action);
 }
 
+void Scene::reportMemory(std::ostream& out)
+{
+	MemoryStats::Build(m_entityManager, assets()).print(out);
+}
+
+//scenes holding copies of animations refresh them here after a hot reload, after calling this to pick up the new ones
+void Scene::onAssetsReloaded(const std::set<std::string>& animations)
+{
+	for (auto& name : animations)
+	{
+		auto it = m_animations.find(name);
+		if (it != m_animations.end()) it->second = assets().animationHandle(name);
+	}
+}
+
+void Scene::onFileChanged(const std::string& /*path*/) {}
+
 void Scene::simulate(const size_t frames)
 {
 	for (int i = 0; i < frames; i++)
@@ -33,11 +87,13 @@ void Scene::registerAction(const int key, const std::string& action)
 
 size_t Scene::width() const
 {
+	if (!m_game) return m_width;
 	return m_game->window().getSize().x; //hmm
 }
 
 size_t Scene::height() const
 {
+	if (!m_game) return m_height;
 	return m_game->window().getSize().y;
 }
 
@@ -46,6 +102,35 @@ size_t Scene::currentFrame() const
 	return m_currentFrame;
 }
 
+const Assets& Scene::assets() const
+{
+	return *m_assets;
+}
+
+//anything outside the manifest goes to the assets, which warn about it and lock, and isn't cached so workers never write
+const Animation& Scene::getAnimation(const std::string& animationName) const
+{
+	auto it = m_animations.find(animationName);
+	if (it != m_animations.end() && it->second) return *it->second;
+	return assets().getAnimation(animationName);
+}
+
+const sf::Font& Scene::getFont(const std::string& fontName) const
+{
+	auto it = m_fonts.find(fontName);
+	if (it != m_fonts.end() && it->second) return *it->second;
+	return assets().getFont(fontName);
+}
+
+bool Scene::isHeadless() const
+{
+	return m_game == nullptr;
+}
+
+const std::string& Scene::musicName() const
+{
+	return m_musicName;
+}
 
 bool Scene::hasEnded() const
 {
@@ -60,5 +145,17 @@ const ActionMap& Scene::getActionMap() const
 void Scene::drawLine(const Vec2& p1, const Vec2& p2)
 {
 	sf::Vertex line[] = { sf::Vector2f(p1.x, p1.y), sf::Vector2f(p2.x, p2.y) };
-	m_game->window().draw(line, 2, sf::Lines);
+	renderer().draw(line, 2, sf::Lines);
+}
+
+void Scene::setRenderer(RenderStats* renderer)
+{
+	m_renderer = renderer;
+}
+
+//where sRender draws, the game window unless an offscreen target was set
+RenderStats& Scene::renderer()
+{
+	if (m_renderer) return *m_renderer;
+	return m_game->renderStats();
 }
\ No newline at end of file
@@ -2,8 +2,12 @@
 
 #include"Action.h"
 #include"EntityManager.h"
+#include"Assets.h"
+#include"RenderStats.h"
 
 #include<memory>
+#include<set>
+#include<unordered_map>
 
 class GameEngine;
 
@@ -13,32 +17,57 @@ class Scene
 {
 protected:
 	
-	GameEngine* m_game = nullptr;
+	GameEngine* m_game = nullptr;	//null for headless scenes that only simulate
+	const Assets* m_assets = nullptr;
+	size_t m_width = 0;
+	size_t m_height = 0;
 	EntityManager m_entityManager;
 	ActionMap m_actionMap;
 	bool m_paused = false;
 	bool m_hasEnded = false;
+	bool m_silent = false;
 	size_t m_currentFrame = 0;
+	std::string m_musicName; //music asset played while this scene is current
+	Assets::Manifest m_manifest; //assets this scene holds, released when it is destroyed
+	std::unordered_map<std::string, std::shared_ptr<const Animation>> m_animations; //the manifest resolved once, so lookups don't lock
+	std::unordered_map<std::string, std::shared_ptr<const sf::Font>> m_fonts;
+	RenderStats* m_renderer = nullptr; //draws somewhere other than the game window, set for offscreen runs
 
 	virtual void onEnd() = 0;
 	void setPaused(bool paused);
+	void playSound(const std::string& soundName);
+	void acquireAssets(const Assets::Manifest& manifest);
 
 public:
 
 	Scene();
 	Scene(GameEngine* gameEngine);
+	Scene(const Assets& assets, size_t width, size_t height);
+	virtual ~Scene();
 
 	virtual void update() = 0;
 	virtual void sDoAction(const Action& action) = 0;
 	virtual void sRender() = 0;
 
 	virtual void doAction(const Action& action);
+	virtual void reportMemory(std::ostream& out);
+	virtual void onAssetsReloaded(const std::set<std::string>& animations);
+	virtual void onFileChanged(const std::string& path);
 	void simulate(const size_t frames);
 	void registerAction(int inputKey, const std::string& actionName);
+	void setSilent(bool silent);
+	void setRenderer(RenderStats* renderer);
+	RenderStats& renderer();
 
 	size_t width() const;
 	size_t height() const;
 	size_t currentFrame() const;
+	const Assets& assets() const;
+	//from what this scene acquired, safe to call from the scene's own workers while it builds
+	const Animation& getAnimation(const std::string& animationName) const;
+	const sf::Font& getFont(const std::string& fontName) const;
+	bool isHeadless() const;
+	const std::string& musicName() const;
 
 	bool hasEnded() const;
 	const ActionMap& getActionMap() const;
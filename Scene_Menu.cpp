@@ -1,11 +1,21 @@
 #include "Scene_Menu.h"
 
+#include <algorithm>
+
 Scene_Menu::Scene_Menu(GameEngine* gameEngine)
     : Scene(gameEngine)
 {
     init();
 }
 
+// builds still running are handed to the engine, a future from std::async would otherwise block here until its level is done
+Scene_Menu::~Scene_Menu()
+{
+    if (!m_game) return;
+    m_game->adoptBuild(std::move(m_preload.world));
+    for (auto& p : m_abandoned) m_game->adoptBuild(std::move(p.world));
+}
+
 void Scene_Menu::init()
 {
     // set up menu strings and text options
@@ -15,8 +25,6 @@ void Scene_Menu::init()
     m_menuStrings.push_back("Level  2");
     m_menuStrings.push_back("Level  3");
 
-    m_menuText.setFont(m_game->assets().getFont("Megaman"));
-    m_menuText.setCharacterSize(64);
 
     // set path to level config files
     m_levelPaths.push_back("bin/level1.txt");
@@ -29,15 +37,73 @@ void Scene_Menu::init()
     registerAction(sf::Keyboard::S, "DOWN");    // move down in menu (looping)
     registerAction(sf::Keyboard::Enter, "PLAY");    // select level and play
 
-    m_game->music().openFromFile("bin/audio/menu.flac");
-    m_game->music().play();
-    m_game->music().setLoop(true);
+    m_musicName = "Menu";
+
+    Assets::Manifest manifest;
+    manifest.fonts = { "Megaman" };
+    acquireAssets(manifest);
+
+    // build the menu once, afterwards only the highlight colour ever changes
+    auto& font = getFont("Megaman");
+
+    auto title = m_ui.add<UIText>(font, 48, m_title);
+    title->setFillColor(sf::Color::Black);
+    title->setPosition(10, 10);
+
+    for (size_t i = 0; i < m_menuStrings.size(); i++)
+    {
+        auto item = m_ui.add<UIText>(font, 64, m_menuStrings[i]);
+        item->setPosition(10.f, 110.f + i * 72);
+        m_menuItems.push_back(item);
+    }
+
+    auto controls = m_ui.add<UIText>(font, 20, "up: W    down: S     play: ENTER      back: ESC");
+    controls->setFillColor(sf::Color::Black);
+    controls->setPosition(10, 690);
+}
+
+// starts building the level behind a menu entry in the background, a build for another entry is left to finish on its own
+void Scene_Menu::preload(size_t index)
+{
+    if (m_preload.world.valid())
+    {
+        if (m_preload.index == index) return;
+        m_abandoned.push_back(std::move(m_preload));
+    }
+
+    auto progress = std::make_shared<std::atomic<float>>(0.f);
+    GameEngine* game = m_game;
+    std::string levelPath = m_levelPaths[index];
+
+    m_preload.index = index;
+    m_preload.progress = progress;
+    m_preload.world = std::async(std::launch::async, [game, levelPath, progress]()
+    {
+        return std::make_shared<Scene_Play>(game, levelPath, 1, progress.get());
+    });
 }
 
 void Scene_Menu::update()
 {
     m_entityManager.update();
-    sRender();
+
+    // not started from init, the first tick comes after the scene this menu replaced has released its level
+    if (!m_preload.world.valid() && !m_playRequested) preload(m_selectedMenuIndex);
+
+    auto done = [](Preload& p) { return p.world.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+    m_abandoned.erase(std::remove_if(m_abandoned.begin(), m_abandoned.end(), done), m_abandoned.end());
+
+    if (!m_playRequested) return;
+    if (!done(m_preload))
+    {
+        m_loadProgress = m_preload.progress->load();
+        return;
+    }
+
+    // the finished world is swapped in whole, the render thread goes from the menu straight to its first frame
+    m_playRequested = false;
+    m_loadProgress = -1.f;
+    m_game->changeScene("PLAY", m_preload.world.get());
 }
 
 void Scene_Menu::onEnd()
@@ -49,18 +115,24 @@ void Scene_Menu::sDoAction(const Action& action)
 {
     if (action.type() == "START")
     {
+        // the chosen level is on its way, only quitting is still allowed
+        if (m_playRequested && action.name() != "QUIT") return;
+
         if (action.name() == "UP")
         {
             if (m_selectedMenuIndex > 0) { m_selectedMenuIndex--; }
             else { m_selectedMenuIndex = m_menuStrings.size() - 1; }
+            preload(m_selectedMenuIndex);
         }
         else if (action.name() == "DOWN")
         {
             m_selectedMenuIndex = (m_selectedMenuIndex + 1) % m_menuStrings.size();
+            preload(m_selectedMenuIndex);
         }
         else if (action.name() == "PLAY")
         {
-            m_game->changeScene("PLAY", std::make_shared<Scene_Play>(m_game, m_levelPaths[m_selectedMenuIndex]));
+            preload(m_selectedMenuIndex);
+            m_playRequested = true;
         }
         else if (action.name() == "QUIT")
         {
@@ -72,31 +144,27 @@ void Scene_Menu::sDoAction(const Action& action)
 void Scene_Menu::sRender()
 {
     // clear to blue
-    m_game->window().setView(m_game->window().getDefaultView());
-    m_game->window().clear(sf::Color(100, 100, 255));
-
-    // draw title
-    m_menuText.setCharacterSize(48);
-    m_menuText.setString(m_title);
-    m_menuText.setFillColor(sf::Color::Black);
-    m_menuText.setPosition(sf::Vector2f(10, 10));
-    m_game->window().draw(m_menuText);
+    auto& renderer = this->renderer();
+    renderer.target().setView(renderer.target().getDefaultView());
+    renderer.target().clear(sf::Color(100, 100, 255));
 
-    // draw options
-    for (size_t i = 0; i < m_menuStrings.size(); i++)
+    // draw title, options and controls, the layer only redraws them when the selection changed
+    for (size_t i = 0; i < m_menuItems.size(); i++)
     {
-        m_menuText.setString(m_menuStrings[i]);
-        m_menuText.setFillColor(i == m_selectedMenuIndex ? sf::Color::White : sf::Color(0, 0, 0));
-        m_menuText.setPosition(sf::Vector2f(10.f, 110.f + i * 72));
-        m_game->window().draw(m_menuText);
+        m_menuItems[i]->setFillColor(i == m_selectedMenuIndex ? sf::Color::White : sf::Color(0, 0, 0));
     }
+    m_ui.draw(renderer);
 
-    // draw controls
-    m_menuText.setCharacterSize(20);
-    m_menuText.setFillColor(sf::Color::Black);
-    m_menuText.setString("up: W    down: S     play: ENTER      back: ESC");
-    m_menuText.setPosition(sf::Vector2f(10, 690));
-    m_game->window().draw(m_menuText);
+    // progress bar under the chosen entry while its level finishes loading
+    float progress = m_loadProgress;
+    if (progress >= 0)
+    {
+        auto bounds = m_menuItems[m_selectedMenuIndex]->getBounds();
+        sf::RectangleShape bar(sf::Vector2f(bounds.width * progress, 6));
+        bar.setPosition(bounds.left, bounds.top + bounds.height + 8);
+        bar.setFillColor(sf::Color::White);
+        renderer.draw(bar);
+    }
 
-    m_game->window().display();
+    renderer.display();
 }
\ No newline at end of file
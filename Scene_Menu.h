@@ -4,10 +4,13 @@
 #include <map>
 #include <memory>
 #include <deque>
+#include <atomic>
+#include <future>
 
 #include "EntityManager.h"
 #include "GameEngine.h"
 #include "Scene_Play.h"
+#include "UI.h"
 
 class Scene_Menu : public Scene
 {
@@ -15,10 +18,26 @@ protected:
     std::string                 m_title;
     std::vector<std::string>    m_menuStrings;
     std::vector<std::string>    m_levelPaths;
-    sf::Text                    m_menuText;
-    size_t                      m_selectedMenuIndex = 0;
+    std::atomic<size_t>         m_selectedMenuIndex{ 0 };   // set by the simulation thread, read by sRender
+
+    UILayer                                 m_ui;
+    std::vector<std::shared_ptr<UIText>>    m_menuItems;
+
+    // a level being built on a worker thread
+    struct Preload
+    {
+        size_t                                      index = 0;
+        std::shared_ptr<std::atomic<float>>         progress;
+        std::future<std::shared_ptr<Scene_Play>>    world;
+    };
+
+    Preload                     m_preload;                  // the highlighted entry, built before it is chosen
+    std::vector<Preload>        m_abandoned;                // highlight moved on, dropped once done so the menu never waits on them
+    bool                        m_playRequested = false;    // enter was pressed, switch as soon as m_preload is ready
+    std::atomic<float>          m_loadProgress{ -1.f };     // shown by sRender while waiting, negative when not
 
     void init();
+    void preload(size_t index);
 
     void update();
     void onEnd();
@@ -28,4 +47,5 @@ protected:
 
 public:
     Scene_Menu(GameEngine* gameEngine = nullptr);
+    ~Scene_Menu();
 };
\ No newline at end of file
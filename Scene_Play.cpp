@@ -4,38 +4,72 @@
 #include "GameEngine.h"
 #include "Components.h"
 #include "Action.h"
+#include "Rollback.h"
+#include "FileWatcher.h"
+#include "BatchMath.h"
+#include "LevelCompiler.h"
+
+#include<sstream>
+#include<future>
+#include<limits>
+#include<cmath>
+
+//last frame the entity is alive for, it goes in that frame's sLifespan
+static size_t lifespanExpiry(const Entity& e)
+{
+	auto& lifespan = e.getComponent<CLifespan>();
+	return lifespan.frameCreated + std::max(lifespan.lifespan, 1) - 1;
+}
 
-Scene_Play::Scene_Play(GameEngine* gameEngine, const std::string& levelPath)
+//safe to build on a worker thread, progress goes from 0 to 1 as the assets and the level come in
+Scene_Play::Scene_Play(GameEngine* gameEngine, const std::string& levelPath, size_t playerCount, std::atomic<float>* progress)
 	:Scene(gameEngine)
+	, m_players(playerCount)
+	, m_levelPath(levelPath)
+{
+	init(m_levelPath, progress);
+}
+
+//headless world for batch simulation, sized like the game window so levels lay out the same
+Scene_Play::Scene_Play(const Assets& assets, const std::string& levelPath, size_t playerCount)
+	:Scene(assets, 1280, 768)
+	, m_players(playerCount)
 	, m_levelPath(levelPath)
+	, m_recording(false)
 {
 	init(m_levelPath);
 }
 
-void Scene_Play::init(const std::string& levelPath)
+void Scene_Play::init(const std::string& levelPath, std::atomic<float>* progress)
 {
 	registerAction(sf::Keyboard::P, "PAUSE");
 	registerAction(sf::Keyboard::Escape, "QUIT");
 	registerAction(sf::Keyboard::T, "TOGGLE_TEXTURE");
 	registerAction(sf::Keyboard::C, "TOGGLE_COLLISION");
 	registerAction(sf::Keyboard::G, "TOGGLE_GRID");
+	registerAction(sf::Keyboard::F3, "TOGGLE_STATS");
+	registerAction(sf::Keyboard::R, "REWIND");
+	registerAction(sf::Keyboard::M, "DUMP_MEMORY");
 
 	registerAction(sf::Keyboard::W, "JUMP");
 	registerAction(sf::Keyboard::A, "LEFT");
 	registerAction(sf::Keyboard::D, "RIGHT");
 	registerAction(sf::Keyboard::Space, "SHOOT");
 
-	m_gridText.setCharacterSize(12);
-	m_gridText.setFont(m_game->assets().getFont("Arial"));
+	//what the players, pickups and hud use, the level's own tiles are acquired as it is read
+	Assets::Manifest manifest;
+	manifest.animations = { "Stand", "Run", "Air", "Buster", "Explosion", "Coin", "Question2", "Goomba" };
+	manifest.fonts = { "Arial", "Megaman" };
+	acquireAssets(manifest);
+	if (progress) *progress = 0.25f;
 
-	m_livesText.setCharacterSize(20);
-	m_livesText.setFont(m_game->assets().getFont("Megaman"));
+	m_gridText.setCharacterSize(12);
+	m_gridText.setFont(getFont("Arial"));
 
-	m_game->music().openFromFile("bin/audio/level.flac");
-	m_game->music().play();
-	m_game->music().setLoop(true);
+	m_musicName = "Level";
 
-	loadLevel(levelPath);
+	loadLevel(levelPath, progress);
+	if (m_game) m_game->watchFile(levelPath);
 }
 
 Vec2 Scene_Play::gridToMidPixel(float gridX, float gridY, std::shared_ptr<Entity> entity)
@@ -45,336 +79,747 @@ Vec2 Scene_Play::gridToMidPixel(float gridX, float gridY, std::shared_ptr<Entity
 	return Vec2(midX, midY);
 }
 
-void Scene_Play::loadLevel(const std::string& filename)
+void Scene_Play::loadLevel(const std::string& filename, std::atomic<float>* progress)
 {
 	m_entityManager = EntityManager();
+	m_expiries.reset(m_currentFrame);
+	m_particles.clear();
+	m_levelEntities.clear();
+	m_enemyTypes.clear();
+	m_tileColumnsStale = true;
+
+	auto entries = readLevel(filename);
+	if (progress) *progress = 0.75f;
+
+	//tiles, decorations and colliders are most of a level and only depend on their own entry, so workers record them
+	//into command buffers while this thread spawns the rest, slots are fixed size chunks of the level so the ids the
+	//merge hands out don't depend on the machine or on which worker finished first
+	std::vector<size_t> statics;
+	std::vector<std::shared_ptr<Entity>> spawned(entries.size());
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (LevelCompiler::IsStatic(entries[i])) statics.push_back(i);
+	}
 
-	std::ifstream fin(filename);
-	std::string entityType="";
-	while (fin >> entityType) 
+	size_t slots = (statics.size() + SPAWN_CHUNK - 1) / SPAWN_CHUNK;
+	m_entityManager.prepareCommands(slots);
+	std::vector<std::future<void>> workers;
+	for (size_t slot = 0; slot < slots; slot++)
 	{
-		if (entityType == "Tile" || entityType == "Dec")
+		workers.push_back(std::async(std::launch::async, [this, slot, &entries, &statics, &spawned]()
 		{
-			std::string animationName;
-			int gx, gy;
+			auto& commands = m_entityManager.commands(slot);
+			size_t end = std::min(statics.size(), (slot + 1) * SPAWN_CHUNK);
+			for (size_t i = slot * SPAWN_CHUNK; i < end; i++) spawned[statics[i]] = spawnLevelEntry(entries[statics[i]], &commands);
+		}));
+	}
 
-			fin >> animationName >> gx >> gy;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (!LevelCompiler::IsStatic(entries[i])) spawned[i] = spawnLevelEntry(entries[i]);
+	}
 
-			auto tile = m_entityManager.addEntity(entityType);
-			tile->addComponent<CAnimation>(m_game->assets().getAnimation(animationName), true);
-			tile->addComponent<CTransform>(gridToMidPixel(gx, gy, tile));
-			if (entityType == "Tile") tile->addComponent<CBoundingBox>(m_game->assets().getAnimation(animationName).getSize());
-		}
-		else if (entityType == "Player")
+	for (size_t slot = 0; slot < workers.size(); slot++)
+	{
+		workers[slot].get();
+		if (progress) *progress = 0.75f + 0.25f * (slot + 1) / workers.size();
+	}
+
+	//the sync point, recorded entities get their ids here
+	m_entityManager.update();
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		if (spawned[i]) m_levelEntities[entries[i]] = spawned[i]->id();
+	}
+	if (progress) *progress = 1.f;
+}
+
+//the level as spawn entries, compiled so plain ground is collided with as a few big rectangles
+std::vector<std::string> Scene_Play::readLevel(const std::string& filename)
+{
+	auto entries = LevelCompiler::Read(filename);
+	acquireAssets(LevelCompiler::Manifest(entries));
+	return LevelCompiler::Compile(entries, assets(), m_gridSize, m_levelStats);
+}
+
+//spawns whatever one level entry describes, returns null for entries that don't map to a single entity
+//static entries may be recorded into a worker's command buffer instead, everything else must spawn on the owning thread
+std::shared_ptr<Entity> Scene_Play::spawnLevelEntry(const std::string& entry, CommandBuffer* commands)
+{
+	std::istringstream fin(entry);
+	std::string entityType;
+	fin >> entityType;
+
+	if (entityType == "Tile" || entityType == "Dec" || entityType == "Merged")
+	{
+		std::string animationName;
+		int gx, gy;
+
+		fin >> animationName >> gx >> gy;
+
+		//a merged tile only draws, its collider does the colliding
+		const std::string tag = (entityType == "Merged") ? "Dec" : entityType;
+		auto tile = commands ? commands->addEntity(tag) : m_entityManager.addEntity(tag);
+		tile->addComponent<CAnimation>(getAnimation(animationName), true);
+		tile->addComponent<CTransform>(gridToMidPixel(gx, gy, tile));
+		if (entityType == "Tile") tile->addComponent<CBoundingBox>(getAnimation(animationName).getSize());
+		return tile;
+	}
+	else if (entityType == "Collider")
+	{
+		int gx, gy, w, h;
+
+		fin >> gx >> gy >> w >> h;
+
+		//tagged as a Tile so every tile collision sees it, with no animation it is never drawn
+		Vec2 size(w * m_gridSize.x, h * m_gridSize.y);
+		auto collider = commands ? commands->addEntity("Tile") : m_entityManager.addEntity("Tile");
+		collider->addComponent<CTransform>(Vec2(gx * m_gridSize.x + size.x / 2.f, height() - gy * m_gridSize.y - size.y / 2.f));
+		collider->addComponent<CBoundingBox>(size);
+		return collider;
+	}
+	else if (commands)
+	{
+		assert(!"only static level entries can be recorded into a command buffer");
+	}
+	else if (entityType == "Player")
+	{
+		fin >> m_playerConfig.X >> m_playerConfig.Y >> m_playerConfig.CX >> m_playerConfig.CY >> m_playerConfig.SPEED >> m_playerConfig.JUMP >> m_playerConfig.MAXSPEED >> m_playerConfig.GRAVITY >> m_playerConfig.WEAPON;
+		for (size_t i = 0; i < m_players.size(); i++) spawnPlayer(i);
+	}
+	else if (entityType == "Enemy")
+	{
+		std::string animationName;
+		int gx, gy;
+		float s;
+
+		fin >> animationName >> gx >> gy >> s;
+
+		auto enemy = m_entityManager.addEntity(entityType);
+
+		enemy->addComponent<CAnimation>(getAnimation("Goomba"), true);
+		enemy->addComponent<CTransform>(gridToMidPixel(gx, gy, enemy));
+		enemy->getComponent<CTransform>().velocity.x = s;
+		enemy->addComponent<CBoundingBox>(getAnimation(animationName).getSize());
+
+		//sight is capped well inside the wake distance so a sleeping enemy can never have seen a player
+		EnemyConfig config;
+		if (m_enemyTypes.count(animationName)) config = m_enemyTypes[animationName];
+		enemy->addComponent<CBehaviour>(config.behaviour, s, std::min(config.sight, width() / 2.f), config.jump, config.interval);
+		enemy->addComponent<CGravity>(config.gravity);	//every enemy is a physics body, patrollers just don't fall
+		return enemy;
+	}
+	else if (entityType == "EnemyType")
+	{
+		std::string name, behaviour;
+		EnemyConfig config;
+
+		fin >> name >> behaviour >> config.sight >> config.jump >> config.interval >> config.gravity;
+
+		if (behaviour == "Chase") config.behaviour = CBehaviour::CHASE;
+		else if (behaviour == "Jump") config.behaviour = CBehaviour::JUMP;
+		else if (behaviour != "Patrol") std::cerr << "Unknown enemy behaviour in level file: " << behaviour << "\n";
+		m_enemyTypes[name] = config;
+	}
+	return nullptr;
+}
+
+//diffs the edited level against what was loaded, only entries that were removed or added are touched,
+//so the players, bullets and everything else in flight keep their state
+void Scene_Play::reloadLevel()
+{
+	auto entries = readLevel(m_levelPath);
+	std::set<std::string> current(entries.begin(), entries.end());
+
+	std::map<size_t, std::shared_ptr<Entity>> byId;
+	for (auto& e : m_entityManager.getEntities()) byId[e->id()] = e;
+
+	size_t removed = 0, added = 0;
+	for (auto it = m_levelEntities.begin(); it != m_levelEntities.end();)
+	{
+		if (current.count(it->first)) { ++it; continue; }
+		if (byId.count(it->second)) byId[it->second]->destroy();
+		it = m_levelEntities.erase(it);
+		removed++;
+	}
+
+	for (auto& entry : entries)
+	{
+		if (m_levelEntities.count(entry)) continue;
+
+		//a changed player line only updates the tuning, the players themselves stay where they are
+		if (entry.compare(0, 7, "Player ") == 0)
 		{
+			std::istringstream fin(entry.substr(7));
 			fin >> m_playerConfig.X >> m_playerConfig.Y >> m_playerConfig.CX >> m_playerConfig.CY >> m_playerConfig.SPEED >> m_playerConfig.JUMP >> m_playerConfig.MAXSPEED >> m_playerConfig.GRAVITY >> m_playerConfig.WEAPON;
-			spawnPlayer();
+			for (auto& p : m_players) if (p) p->getComponent<CGravity>().gravity = m_playerConfig.GRAVITY;
+			continue;
 		}
-		else if (entityType == "Enemy")
-		{
-			std::string animationName;
-			int gx, gy;
-			float s;
 
-			fin >> animationName >> gx >> gy >> s;
+		auto e = spawnLevelEntry(entry);
+		if (e) { m_levelEntities[entry] = e->id(); added++; }
+	}
+
+	m_staticStale = true;
+	m_tileColumnsStale = true;
+	std::cout << "reloaded level " << m_levelPath << ": " << removed << " removed, " << added << " added\n";
+}
 
-			auto enemy = m_entityManager.addEntity(entityType);
+void Scene_Play::onFileChanged(const std::string& path)
+{
+	if (path == FileWatcher::normalize(m_levelPath)) reloadLevel();
+}
 
-			enemy->addComponent<CAnimation>(m_game->assets().getAnimation("Goomba"), true);
-			enemy->addComponent<CTransform>(gridToMidPixel(gx, gy, enemy));
-			enemy->getComponent<CTransform>().velocity.x = s;
-			enemy->addComponent<CBoundingBox>(m_game->assets().getAnimation(animationName).getSize());
-		}
-		else
+//swaps in the rebuilt animations but keeps each entity on the frame it was showing
+void Scene_Play::onAssetsReloaded(const std::set<std::string>& animations)
+{
+	Scene::onAssetsReloaded(animations);
+	for (auto& e : m_entityManager.view<CAnimation>())
+	{
+		auto& anim = e->getComponent<CAnimation>().animation;
+		if (!animations.count(anim.getName())) continue;
+
+		size_t frame = anim.getCurrentFrame();
+		anim = getAnimation(anim.getName());
+		anim.setCurrentFrame(frame);
+
+		if ((e->tag() == "Tile" || e->tag() == "Enemy") && e->hasComponent<CBoundingBox>())
 		{
-			std::cerr << "Unknown entity name in level file: " << filename << "\n";
+			auto& box = e->getComponent<CBoundingBox>();
+			box.size = anim.getSize();
+			box.halfSize = anim.getSize() / 2;
 		}
 	}
+	m_staticLayer.invalidateAll();
+	m_staticStale = true;
 }
 
-void Scene_Play::spawnPlayer()
+//second player starts one tile to the right of the first and has its own tag so saved state can tell them apart
+void Scene_Play::spawnPlayer(size_t index)
 {
-	m_player = m_entityManager.addEntity("Player");
+	auto player = m_entityManager.addEntity(index == 0 ? "Player" : "Player2");
+
+	player->addComponent<CAnimation>(getAnimation("Stand"), true);
+	player->addComponent<CTransform>(gridToMidPixel(m_playerConfig.X + index, m_playerConfig.Y, player));
+	player->addComponent<CInput>();
+	player->addComponent<CBoundingBox>(Vec2(m_playerConfig.CX,m_playerConfig.CY));
+	player->addComponent<CGravity>(m_playerConfig.GRAVITY);
+	player->addComponent<CState>();
 
-	m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Stand"), true);
-	m_player->addComponent<CTransform>(gridToMidPixel(m_playerConfig.X,m_playerConfig.Y,m_player));
-	m_player->addComponent<CInput>();
-	m_player->addComponent<CBoundingBox>(Vec2(m_playerConfig.CX,m_playerConfig.CY));
-	m_player->addComponent<CGravity>(m_playerConfig.GRAVITY);
-	m_player->addComponent<CState>();
+	m_players[index] = player;
+	if (index == m_localPlayer) m_player = player;
 }
 
 void Scene_Play::spawnBullet(std::shared_ptr<Entity> entity)
 {
-	if (!m_player->getComponent<CInput>().canShoot) return;
+	if (!entity->getComponent<CInput>().canShoot) return;
 
 	auto bullet = m_entityManager.addEntity("Bullet");
+	playSound("Shoot");
 
-	bullet->addComponent<CAnimation>(m_game->assets().getAnimation("Buster"),true);
+	bullet->addComponent<CAnimation>(getAnimation("Buster"),true);
 	bullet->addComponent<CTransform>(entity->getComponent<CTransform>().pos);
 
 	if(entity->getComponent<CTransform>().scale.x==1) bullet->getComponent<CTransform>().velocity.x = 10;
 	else bullet->getComponent<CTransform>().velocity.x = -10;
 	
-	bullet->addComponent<CBoundingBox>(m_game->assets().getAnimation("Buster").getSize());
-	bullet->addComponent<CLifespan>(45, m_currentFrame);
+	bullet->addComponent<CBoundingBox>(getAnimation("Buster").getSize());
+	setLifespan(bullet, 45);
 }
 
 void Scene_Play::update()
 {
 	if (!m_paused) 
 	{
-		m_entityManager.update();
+		if (m_rewinding)
+		{
+			sRewind();
+		}
+		else if (m_session)
+		{
+			m_session->advance(m_localInput);
+		}
+		else
+		{
+			step();
+		}
+	}
+	//a headless world with an offscreen renderer is drawn too
+	if (!isHeadless() || m_renderer)
+	{
+		//once per real tick, a rollback resimulating several frames doesn't speed particles up
+		if (!m_paused) m_particles.update();
+		publishFrame();
+	}
+}
 
-		sMovement();
-		sCollision();
-		sLifespan();
-		sAnimation();
+//one simulation tick, no rendering
+void Scene_Play::step()
+{
+	Profiler::Timer timer(m_profiler);
+
+	m_entityManager.update();	timer.lap("EntityManager");
+
+	sAI();			timer.lap("sAI");
+	sMovement();	timer.lap("sMovement");
+	sCollision();	timer.lap("sCollision");
+	sLifespan();	timer.lap("sLifespan");
+	sAnimation();	timer.lap("sAnimation");
+
+	m_currentFrame++;
+	if (m_recording) sRecord();
+}
+
+//sets a player's held actions from a mask, newly pressed or released buttons behave like START/END
+//used by netplay so inputs land on tick boundaries and replay identically after a rollback
+void Scene_Play::setInputMask(size_t playerIndex, uint8_t mask)
+{
+	auto player = m_players[playerIndex];
+	auto& input = player->getComponent<CInput>();
+
+	input.jump = (mask & INPUT_JUMP) != 0;
+	input.left = (mask & INPUT_LEFT) != 0;
+	input.right = (mask & INPUT_RIGHT) != 0;
+
+	bool shoot = (mask & INPUT_SHOOT) != 0;
+	if (shoot && !input.shoot)
+	{
+		spawnBullet(player);
+		input.shoot = true;
+		input.canShoot = false;
+	}
+	else if (!shoot && input.shoot)
+	{
+		input.shoot = false;
+		input.canShoot = true;
 	}
-	sRender();
 }
 
-void Scene_Play::sMovement()
+void Scene_Play::startNetplay(size_t localPlayer, unsigned short localPort, const std::string& remoteAddress, unsigned short remotePort)
 {
-	auto& playerInput = m_player->getComponent<CInput>();
-	Vec2 playerVelocity(0.f, m_player->getComponent<CTransform>().velocity.y);
-	m_player->getComponent<CState>().run = false;
-	
-	if (playerInput.left)
+	m_localPlayer = localPlayer;
+	m_player = m_players[localPlayer];
+	setRecording(false);
+	m_session = std::make_shared<RollbackSession>(*this, localPlayer, localPort, remoteAddress, remotePort);
+}
+
+std::shared_ptr<RollbackSession> Scene_Play::session()
+{
+	return m_session;
+}
+
+//saves the frame that was just simulated into the rewind buffer
+void Scene_Play::sRecord()
+{
+	sf::Clock clock;
+	captureState(m_worldState);
+	m_rewind.push(m_worldState);
+	m_rewind.recordPushTime((float)clock.getElapsedTime().asMicroseconds());
+}
+
+//steps back one frame per update while the rewind key is held
+void Scene_Play::sRewind()
+{
+	if (m_currentFrame == 0 || !m_rewind.contains(m_currentFrame - 1)) return;
+
+	//keep the keys the player is holding right now rather than the recorded ones
+	CInput input = m_player->getComponent<CInput>();
+	m_rewind.restore(m_currentFrame - 1, m_worldState);
+	restoreState(m_worldState);
+	m_player->getComponent<CInput>() = input;
+}
+
+void Scene_Play::reportMemory(std::ostream& out)
+{
+	Scene::reportMemory(out);
+	out << "rewind buffer: " << m_rewind.frameCount() << " frames, " << m_rewind.bytesUsed() << " bytes\n";
+	out << "particles: " << m_particles.bytesUsed() << " bytes\n";
+	LevelCompiler::PrintStats(m_levelPath, m_levelStats, out);
+}
+
+//times every system of every step until set back to null
+void Scene_Play::setProfiler(Profiler* profiler)
+{
+	m_profiler = profiler;
+}
+
+void Scene_Play::setRecording(bool recording)
+{
+	m_recording = recording;
+	if (!recording) m_rewind.clear();
+}
+
+int Scene_Play::lives() const
+{
+	return m_lives;
+}
+
+std::shared_ptr<Entity> Scene_Play::player()
+{
+	return m_player;
+}
+
+EntityManager& Scene_Play::entities()
+{
+	return m_entityManager;
+}
+
+const Vec2& Scene_Play::gridSize() const
+{
+	return m_gridSize;
+}
+
+void Scene_Play::captureState(WorldState& state)
+{
+	Snapshot::Capture(m_entityManager, m_names, state);
+	state.frame = m_currentFrame;
+	state.lives = m_lives;
+}
+
+void Scene_Play::restoreState(const WorldState& state)
+{
+	std::set<std::string> changed;
+	Snapshot::Restore(state, m_entityManager, *this, m_names, changed);
+	m_currentFrame = state.frame;
+	m_lives = state.lives;
+
+	//a freshly respawned player can still be in the add list
+	for (size_t i = 0; i < m_players.size(); i++)
 	{
-		playerVelocity.x -= m_playerConfig.SPEED;
-		m_player->getComponent<CTransform>().scale.x = -1;
-		m_player->getComponent<CState>().run = true;
+		const std::string tag = (i == 0) ? "Player" : "Player2";
+		for (auto e : m_entityManager.getEntities(tag)) { if (e->isActive()) m_players[i] = e; }
+		for (auto e : m_entityManager.getPendingEntities()) { if (e->isActive() && e->tag() == tag) m_players[i] = e; }
 	}
-	if (playerInput.right)
+	m_player = m_players[m_localPlayer];
+	//tiles only differ when a brick or question block was hit inside the rolled back frames
+	if (changed.count("Tile") || changed.count("Dec"))
 	{
-		playerVelocity.x += m_playerConfig.SPEED;
-		m_player->getComponent<CTransform>().scale.x = 1;
-		m_player->getComponent<CState>().run = true;
+		m_staticStale = true;
+		m_tileColumnsStale = true;
 	}
-	if (playerInput.jump && !m_player->getComponent<CState>().air)
+
+	//timers aren't part of the snapshot, the lifespans they come from are
+	m_expiries.reset(m_currentFrame);
+	for (auto& e : m_entityManager.getEntities()) { if (e->hasComponent<CLifespan>()) m_expiries.schedule(lifespanExpiry(*e), e); }
+	for (auto& e : m_entityManager.getPendingEntities()) { if (e->hasComponent<CLifespan>()) m_expiries.schedule(lifespanExpiry(*e), e); }
+}
+
+//signed horizontal distance from e to the closest player
+float Scene_Play::nearestPlayerDx(const Entity& e) const
+{
+	float best = std::numeric_limits<float>::infinity();
+	for (auto& player : m_players)
 	{
-		playerVelocity.y = m_playerConfig.JUMP;
+		if (!player) continue;
+		float dx = player->getComponent<CTransform>().pos.x - e.getComponent<CTransform>().pos.x;
+		if (std::abs(dx) < std::abs(best)) best = dx;
+	}
+	return best;
+}
+
+//enemies far from every player are put to sleep: they stop moving and colliding, and every AI_LOD_INTERVAL frames
+//or when a player gets close they are replayed frame by frame through the same think/integrate/collide steps
+//an awake enemy takes, so they come back exactly where full simulation would have put them
+//distances use the players rather than the camera so netplay peers make the same decisions
+void Scene_Play::sAI()
+{
+	if (m_tileColumnsStale)
+	{
+		m_physics.setTiles(m_entityManager.getEntities("Tile"));
+		m_tileColumnsStale = false;
 	}
 
-	m_player->getComponent<CTransform>().velocity = playerVelocity;
+	for (auto& batch : m_aiBatches) batch.clear();
 
-	for (auto e : m_entityManager.getEntities())
+	const float wakeDistance = (float)width();
+	const float sleepDistance = width() * 1.25f;
+	for (auto& enemy : m_entityManager.view<CTransform, CBehaviour>())
 	{
-		e->getComponent<CTransform>().prevPos = e->getComponent<CTransform>().pos;
+		auto& behaviour = enemy->getComponent<CBehaviour>();
+		float distance = std::abs(nearestPlayerDx(*enemy));
 
-		if (e->hasComponent<CGravity>()) 
+		if (behaviour.asleep)
 		{
-			e->getComponent<CTransform>().velocity.y += e->getComponent<CGravity>().gravity;
-
-			if (std::abs(playerVelocity.y) > m_playerConfig.MAXSPEED) playerVelocity.y = m_playerConfig.MAXSPEED;
-			if (std::abs(playerVelocity.x) > m_playerConfig.MAXSPEED) playerVelocity.x = m_playerConfig.MAXSPEED;
+			if (distance < wakeDistance) wakeEnemy(enemy);
+			else if (m_currentFrame - behaviour.frame >= AI_LOD_INTERVAL) replayEnemy(enemy);
+			if (behaviour.asleep) continue;
+		}
+		else if (distance > sleepDistance)
+		{
+			sleepEnemy(enemy);
+			continue;
 		}
 
-		e->getComponent<CTransform>().pos += e->getComponent<CTransform>().velocity;
+		m_aiBatches[behaviour.type].push_back(enemy);
 	}
+
+	//patrollers only react to walls, which is handled in collision
+	for (auto& enemy : m_aiBatches[CBehaviour::CHASE]) thinkEnemy(enemy, nearestPlayerDx(*enemy));
+	for (auto& enemy : m_aiBatches[CBehaviour::JUMP]) thinkEnemy(enemy, nearestPlayerDx(*enemy));
 }
 
-void Scene_Play::sLifespan()
+void Scene_Play::thinkEnemy(std::shared_ptr<Entity> enemy, float playerDx)
 {
-	for (auto e : m_entityManager.getEntities())
+	auto& behaviour = enemy->getComponent<CBehaviour>();
+	auto& velocity = enemy->getComponent<CTransform>().velocity;
+
+	if (behaviour.type == CBehaviour::CHASE)
+	{
+		if (std::abs(playerDx) <= behaviour.sight) velocity.x = playerDx < 0 ? -std::abs(behaviour.speed) : std::abs(behaviour.speed);
+	}
+	else if (behaviour.type == CBehaviour::JUMP && behaviour.grounded)
 	{
-		if (e->hasComponent<CLifespan>()) 
+		if (behaviour.timer == 0)
 		{
-			e->getComponent<CLifespan>().lifespan--;
-			if (e->getComponent<CLifespan>().lifespan <= 0) e->destroy();
+			velocity.y = behaviour.jump;
+			behaviour.grounded = false;
+			behaviour.timer = behaviour.interval;
 		}
+		else behaviour.timer--;
 	}
 }
 
-void Scene_Play::sCollision()
+//tiles for one enemy outside the world step, sAI uses it to replay a sleeping one
+void Scene_Play::collideEnemy(std::shared_ptr<Entity> enemy)
+{
+	m_physics.resolve(enemy);
+	enemyContacts(enemy);
+}
+
+//turns around at a wall it is walking into, a jumper may jump again once it has landed
+void Scene_Play::enemyContacts(std::shared_ptr<Entity> enemy)
+{
+	auto& velocity = enemy->getComponent<CTransform>().velocity;
+	uint8_t contacts = enemy->getComponent<CGravity>().contacts;
+
+	if ((contacts & Physics::CONTACT_WALL_RIGHT && velocity.x > 0) || (contacts & Physics::CONTACT_WALL_LEFT && velocity.x < 0))
+	{
+		velocity.x *= -1;
+	}
+	enemy->getComponent<CBehaviour>().grounded = (contacts & Physics::CONTACT_GROUND) != 0;
+}
+
+//parks the enemy, sMovement sees zero velocity and gravity so its integration is a no-op
+void Scene_Play::sleepEnemy(std::shared_ptr<Entity> enemy)
+{
+	auto& behaviour = enemy->getComponent<CBehaviour>();
+	auto& transform = enemy->getComponent<CTransform>();
+
+	behaviour.asleep = true;
+	behaviour.frame = m_currentFrame;
+	behaviour.sleepVelocity = transform.velocity;
+	transform.velocity = Vec2(0, 0);
+	behaviour.sleepGravity = enemy->getComponent<CGravity>().gravity;
+	enemy->getComponent<CGravity>().gravity = 0;
+}
+
+//advances a sleeping enemy up to the current frame, the player can't be within sight while it sleeps
+void Scene_Play::replayEnemy(std::shared_ptr<Entity> enemy)
+{
+	auto& behaviour = enemy->getComponent<CBehaviour>();
+	auto& transform = enemy->getComponent<CTransform>();
+	float gravity = behaviour.sleepGravity;
+
+	transform.velocity = behaviour.sleepVelocity;
+	for (size_t f = behaviour.frame; f < m_currentFrame; f++)
+	{
+		thinkEnemy(enemy, std::numeric_limits<float>::infinity());
+		transform.prevPos = transform.pos;
+		transform.velocity.y += gravity;
+		transform.pos += transform.velocity;
+		collideEnemy(enemy);
+	}
+
+	behaviour.frame = m_currentFrame;
+	behaviour.sleepVelocity = transform.velocity;
+	transform.velocity = Vec2(0, 0);
+}
+
+void Scene_Play::wakeEnemy(std::shared_ptr<Entity> enemy)
 {
-	auto& playerPos = m_player->getComponent<CTransform>().pos;
-	auto& playerVelo = m_player->getComponent<CTransform>().velocity;
-	auto& playerState = m_player->getComponent<CState>();
+	replayEnemy(enemy);
+
+	auto& behaviour = enemy->getComponent<CBehaviour>();
+	behaviour.asleep = false;
+	enemy->getComponent<CTransform>().velocity = behaviour.sleepVelocity;
+	enemy->getComponent<CGravity>().gravity = behaviour.sleepGravity;
+}
+
+void Scene_Play::sMovement()
+{
+	for (auto& player : m_players)
+	{
+		sPlayerMovement(player);
+	}
+
+	//gather into flat arrays, integrate in one pass, then write back
+	//an entity without CGravity has the default component with zero gravity, so no branch is needed
+	//players (the only entities with input) go first, so their speed limit is one run over the front of the arrays
+	auto& view = m_entityManager.view<CTransform>();
+	m_movers.clear();
+	for (auto& e : view) { if (e->hasComponent<CInput>()) m_movers.push_back(e.get()); }
+	size_t players = m_movers.size();
+	for (auto& e : view) { if (!e->hasComponent<CInput>()) m_movers.push_back(e.get()); }
+
+	size_t n = m_movers.size();
+	m_bodies.resize(n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		auto& t = m_movers[i]->getComponent<CTransform>();
+		t.prevPos = t.pos;
+		m_bodies.px[i] = t.pos.x;
+		m_bodies.py[i] = t.pos.y;
+		m_bodies.vx[i] = t.velocity.x;
+		m_bodies.vy[i] = t.velocity.y;
+		m_bodies.gravity[i] = m_movers[i]->getComponent<CGravity>().gravity;
+	}
+
+	BatchMath::ApplyGravity(m_bodies.vy.data(), m_bodies.gravity.data(), n);
+	BatchMath::ClampVelocity(m_bodies.vx.data(), m_bodies.vy.data(), m_playerConfig.MAXSPEED, m_playerConfig.MAXSPEED, players);
+	BatchMath::Integrate(m_bodies.px.data(), m_bodies.py.data(), m_bodies.vx.data(), m_bodies.vy.data(), n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		auto& t = m_movers[i]->getComponent<CTransform>();
+		t.pos = Vec2(m_bodies.px[i], m_bodies.py[i]);
+		t.velocity = Vec2(m_bodies.vx[i], m_bodies.vy[i]);
+	}
+}
 
-	playerState.air = true;
-	playerState.stand = false;
+//turns a player's input into velocity
+void Scene_Play::sPlayerMovement(std::shared_ptr<Entity> player)
+{
+	auto& playerInput = player->getComponent<CInput>();
+	Vec2 playerVelocity(0.f, player->getComponent<CTransform>().velocity.y);
+	player->getComponent<CState>().run = false;
 	
+	if (playerInput.left)
+	{
+		playerVelocity.x -= m_playerConfig.SPEED;
+		player->getComponent<CTransform>().scale.x = -1;
+		player->getComponent<CState>().run = true;
+	}
+	if (playerInput.right)
+	{
+		playerVelocity.x += m_playerConfig.SPEED;
+		player->getComponent<CTransform>().scale.x = 1;
+		player->getComponent<CState>().run = true;
+	}
+	if (playerInput.jump && !player->getComponent<CState>().air)
+	{
+		playerVelocity.y = m_playerConfig.JUMP;
+		playSound("Jump");
+	}
+
+	player->getComponent<CTransform>().velocity = playerVelocity;
+}
+
+//registered once, sLifespan never looks at it again until the frame it runs out
+void Scene_Play::setLifespan(std::shared_ptr<Entity> entity, int frames)
+{
+	entity->addComponent<CLifespan>(frames, m_currentFrame);
+	m_expiries.schedule(lifespanExpiry(*entity), entity);
+}
+
+//only touches the entities whose lifespan ends this frame
+void Scene_Play::sLifespan()
+{
+	assert(m_expiries.now() == m_currentFrame);
+
+	m_expired.clear();
+	m_expiries.advance(m_expired);
+	for (auto& weak : m_expired)
+	{
+		//already gone, or given a new lifespan since this timer was set
+		auto e = weak.lock();
+		if (!e || !e->hasComponent<CLifespan>() || lifespanExpiry(*e) != m_currentFrame) continue;
+		e->destroy();
+	}
+}
+
+void Scene_Play::sCollision()
+{
 	//bullet collisons
 	for (auto bullet : m_entityManager.getEntities("Bullet"))
 	{
 		//bullet tile
-		for (auto tile : m_entityManager.getEntities("Tile"))
+		auto tile = findHit(bullet, "Tile");
+		if (tile)
 		{
-			Vec2 overlap = Physics::GetOverlap(bullet, tile);
-			if (overlap.x > 0 && overlap.y > 0) 
-			{
-				bullet->destroy();
-
-				if (tile->getComponent<CAnimation>().animation.getName() == "Brick") 
-				{
-					tile->destroy();
+			bullet->destroy();
 
-					auto boom = m_entityManager.addEntity("Boom");
-					boom->addComponent<CAnimation>(m_game->assets().getAnimation("Explosion"), false);
-					boom->addComponent<CTransform>(tile->getComponent<CTransform>().pos);
-				}
+			if (tile->getComponent<CAnimation>().animation.getName() == "Brick") 
+			{
+				settleSleepers(*tile);
+				tile->destroy();
+				invalidateTile(tile);
+				playSound("Brick");
 
-				break;
+				explode(tile);
 			}
 		}
 		//bullet enemy
-		for (auto enemy : m_entityManager.getEntities("Enemy"))
+		auto enemy = findHit(bullet, "Enemy");
+		if (enemy)
 		{
-			Vec2 overlap = Physics::GetOverlap(bullet, enemy);
-			if (overlap.x > 0 && overlap.y > 0)
-			{
-				bullet->destroy();
-				enemy->destroy();
+			bullet->destroy();
+			enemy->destroy();
 
-				auto boom = m_entityManager.addEntity("Boom");
-				boom->addComponent<CAnimation>(m_game->assets().getAnimation("Explosion"), false);
-				boom->addComponent<CTransform>(enemy->getComponent<CTransform>().pos);
-
-				break;
-			}
+			explode(enemy);
 		}
 	}
 
-	//enemy tile
-	for (auto enemy : m_entityManager.getEntities("Enemy"))
+	//bodies against tiles, sleeping enemies are parked and collide when sAI replays them
+	m_physicsBodies.clear();
+	for (auto& body : m_entityManager.view<CTransform, CBoundingBox, CGravity>())
 	{
-		for (auto tile : m_entityManager.getEntities("Tile"))
-		{
-			Vec2 overlap = Physics::GetOverlap(enemy, tile);
-			if (overlap.x > 0 && overlap.y > 0)
-			{
-				auto& tilePos = tile->getComponent<CTransform>().pos;
-				auto& prevEnemyPos = enemy->getComponent<CTransform>().prevPos;
-				auto& currEnemyPos = enemy->getComponent<CTransform>().pos;
-				//from left
-				if (prevEnemyPos.x < tilePos.x)
-				{
-					currEnemyPos.x -= overlap.x;
-				}
-				//comes from right
-				else
-				{
-					currEnemyPos.x += overlap.x;
-				}
-				enemy->getComponent<CTransform>().velocity.x *= -1;
-				break;
-			}
-		}
+		if (body->hasComponent<CBehaviour>() && body->getComponent<CBehaviour>().asleep) continue;
+		m_physicsBodies.push_back(body);
 	}
+	m_physics.step(m_physicsBodies);
 
-	//player tile 
-	for (auto tile : m_entityManager.getEntities("Tile"))
+	for (auto& enemy : m_physicsBodies)
 	{
-		Vec2 overlap = Physics::GetOverlap(m_player, tile);
+		if (enemy->isActive() && enemy->tag() == "Enemy") enemyContacts(enemy);
+	}
 
-		//current overlap
-		if (overlap.x > 0 && overlap.y > 0)
-		{
-			auto& prevPlayerPos = m_player->getComponent<CTransform>().prevPos;
-			auto& currPlayerPos = m_player->getComponent<CTransform>().pos;
-			auto& tilePos 		= tile->getComponent<CTransform>().pos;
-			Vec2 prevOverlap = Physics::GetPreviousOverlap(m_player, tile);
+	for (size_t i = 0; i < m_players.size(); i++)
+	{
+		sPlayerCollision(m_players[i], i);
+	}
 
-			if (tile->getComponent<CAnimation>().animation.getName() == "Pole") {
-				onEnd();
-			}
+}
 
-			//prev vertical overlap only
-			if (prevOverlap.x > 0 && prevOverlap.y == 0)
-			{
-				//comes from above
-				if (prevPlayerPos.y < tilePos.y)
-				{
-					currPlayerPos.y -= overlap.y;
-					playerState.stand = true;
-					playerState.air = false;
-				}
-				//comes from below
-				else
-				{
-					currPlayerPos.y += overlap.y;
-
-					auto& tileAnimation = tile->getComponent<CAnimation>().animation;
-
-					if (tileAnimation.getName() == "Brick") 
-					{
-						tile->destroy();
-
-						auto boom = m_entityManager.addEntity("Boom");
-						boom->addComponent<CAnimation>(m_game->assets().getAnimation("Explosion"), false);
-						boom->addComponent<CTransform>(tilePos);
-					}
-					else if (tileAnimation.getName() == "Question")
-					{
-						tile->addComponent<CAnimation>(m_game->assets().getAnimation("Question2"),true);
-
-						auto coin = m_entityManager.addEntity("Coin");
-						coin->addComponent<CAnimation>(m_game->assets().getAnimation("Coin"),false);
-						coin->addComponent<CTransform>(Vec2(tilePos.x, tilePos.y - m_gridSize.y));
-					}
-				}
-				m_player->getComponent<CTransform>().velocity.y = 0;
-			}
-			//prev hori overlap only
-			else if (prevOverlap.x==0 && prevOverlap.y > 0)
-			{
-				//comes from left
-				if (prevPlayerPos.x < tilePos.x)
-				{
-					currPlayerPos.x -= overlap.x;
-				}
-				//comes from right
-				else
-				{
-					currPlayerPos.x += overlap.x;
-				}
-				playerVelo.x = 0;
-			}
-			//no prev overlap ie player came diagonally
-			else
-			{
-				//first do x movement and resolve
-				float temp = currPlayerPos.y; //save new y position
-				currPlayerPos.y = prevPlayerPos.y;
-
-				for (auto tile : m_entityManager.getEntities("Tile"))
-				{
-					Vec2 overlap = Physics::GetOverlap(m_player, tile);
-					if (overlap.x > 0 && overlap.y > 0) 
-					{
-						currPlayerPos.x = prevPlayerPos.x;
-						break;
-					}
-				}
-
-				//do y movement 
-				currPlayerPos.y = temp;
-
-				for (auto tile : m_entityManager.getEntities("Tile"))
-				{
-					Vec2 overlap = Physics::GetOverlap(m_player, tile);
-
-					if (overlap.x > 0 && overlap.y > 0) 
-					{
-						currPlayerPos.y = prevPlayerPos.y;
-						if (prevPlayerPos.y < tile->getComponent<CTransform>().pos.y)
-						{
-							playerState.stand = true;
-							playerState.air = false;
-						}
-						break;
-					}
-				}
-			}
+//tiles, enemies and the level bounds for one player
+void Scene_Play::sPlayerCollision(std::shared_ptr<Entity> player, size_t index)
+{
+	auto& playerPos = player->getComponent<CTransform>().pos;
+	auto& playerVelo = player->getComponent<CTransform>().velocity;
+	auto& playerState = player->getComponent<CState>();
+
+	//tiles were resolved in the world step, what's left is what the player does about them
+	uint8_t contacts = player->getComponent<CGravity>().contacts;
+	playerState.stand = (contacts & Physics::CONTACT_GROUND) != 0;
+	playerState.air = !playerState.stand;
+	if (contacts & (Physics::CONTACT_WALL_LEFT | Physics::CONTACT_WALL_RIGHT)) playerVelo.x = 0;
+
+	//by index and by value, breaking a block replays sleepers near it and their resolves add hits
+	for (size_t i = 0; i < m_physics.hits().size(); i++)
+	{
+		auto hit = m_physics.hits()[i];
+		if (hit.body != player) continue;
+
+		if (hit.tile->getComponent<CAnimation>().animation.getName() == "Pole") {
+			onEnd();
 		}
+		if (hit.contact == Physics::CONTACT_CEILING) hitBlockFromBelow(hit.tile);
 	}
 
 	//player enemy 
 	for (auto enemy : m_entityManager.getEntities("Enemy"))
 	{
-		Vec2 overlap = Physics::GetOverlap(m_player, enemy);
+		Vec2 overlap = Physics::GetOverlap(player, enemy);
 		//current overlap
 		if (overlap.x > 0 && overlap.y > 0)
 		{
@@ -382,9 +827,7 @@ void Scene_Play::sCollision()
 			{
 				enemy->destroy();
 
-				auto boom = m_entityManager.addEntity("Boom");
-				boom->addComponent<CAnimation>(m_game->assets().getAnimation("Explosion"), false);
-				boom->addComponent<CTransform>(enemy->getComponent<CTransform>().pos);
+				explode(enemy);
 
 				playerVelo.y = -m_playerConfig.MAXSPEED/1.5f;
 			}
@@ -392,8 +835,8 @@ void Scene_Play::sCollision()
 			{
 				m_lives--;
 				if (!m_lives) onEnd();
-				m_player->destroy();
-				spawnPlayer();
+				player->destroy();
+				spawnPlayer(index);
 			}	
 			break;
 		}
@@ -404,16 +847,127 @@ void Scene_Play::sCollision()
 	{
 		m_lives--;
 		if (!m_lives) onEnd();
-		m_player->destroy();
-		spawnPlayer();
+		player->destroy();
+		spawnPlayer(index);
 	}
 
 	//dont let player walk off the left of map
-	if (playerPos.x < m_player->getComponent<CBoundingBox>().halfSize.x)
+	if (playerPos.x < player->getComponent<CBoundingBox>().halfSize.x)
 	{
-		playerPos.x = m_player->getComponent<CBoundingBox>().halfSize.x;
+		playerPos.x = player->getComponent<CBoundingBox>().halfSize.x;
 	}
+}
 
+//breaks a brick or empties a question block the player hit with their head
+void Scene_Play::hitBlockFromBelow(std::shared_ptr<Entity> tile)
+{
+	auto& tilePos = tile->getComponent<CTransform>().pos;
+	auto& tileAnimation = tile->getComponent<CAnimation>().animation;
+
+	if (tileAnimation.getName() == "Brick") 
+	{
+		settleSleepers(*tile);
+		tile->destroy();
+		invalidateTile(tile);
+		playSound("Brick");
+
+		explode(tile);
+	}
+	else if (tileAnimation.getName() == "Question")
+	{
+		tile->addComponent<CAnimation>(getAnimation("Question2"),true);
+		invalidateTile(tile);
+		playSound("Coin");
+
+		auto coin = m_entityManager.addEntity("Coin");
+		coin->addComponent<CAnimation>(getAnimation("Coin"),false);
+		coin->addComponent<CTransform>(Vec2(tilePos.x, tilePos.y - m_gridSize.y));
+	}
+}
+
+//explosions and debris are cosmetic, so like sounds they are skipped headless and while a rollback resimulates
+void Scene_Play::explode(std::shared_ptr<Entity> e)
+{
+	if (isHeadless() || m_silent) return;
+
+	auto& pos = e->getComponent<CTransform>().pos;
+	m_particles.emitAnimation(getAnimation("Explosion"), pos);
+	m_particles.emitDebris(e->getComponent<CAnimation>().animation, pos);
+}
+
+//a tile broke or changed, only its item is patched and only the chunks under it are baked again
+//the physics columns can stay, they skip tiles that aren't active and a question block is still solid
+void Scene_Play::invalidateTile(std::shared_ptr<Entity> tile)
+{
+	if (!m_staticStale) m_staticPatches.push_back(tile);
+}
+
+//a sleeping enemy is still where it fell asleep rather than where it is, so nothing hits it until sAI catches it up
+//sAI wakes everything within a screen of a player before collisions run, further than a bullet can travel
+static bool isParked(const Entity& e)
+{
+	return e.hasComponent<CBehaviour>() && e.getComponent<CBehaviour>().asleep;
+}
+
+//replays sleeping enemies that may have walked past a tile up to now, before it changes
+//the catch up would otherwise run them against the tile as it is after the change
+void Scene_Play::settleSleepers(const Entity& tile)
+{
+	const float tileX = tile.getComponent<CTransform>().pos.x;
+	for (auto& enemy : m_entityManager.view<CTransform, CBehaviour>())
+	{
+		auto& behaviour = enemy->getComponent<CBehaviour>();
+		if (!behaviour.asleep) continue;
+		float reach = std::abs(behaviour.sleepVelocity.x) * (m_currentFrame - behaviour.frame) + 2 * m_gridSize.x;
+		if (std::abs(enemy->getComponent<CTransform>().pos.x - tileX) <= reach) replayEnemy(enemy);
+	}
+}
+
+//earliest swept contact between e and any entity with the given tag
+std::shared_ptr<Entity> Scene_Play::firstSweepHit(std::shared_ptr<Entity> e, const std::string& tag, Physics::Sweep& sweep)
+{
+	std::shared_ptr<Entity> hit;
+	sweep = Physics::Sweep();
+	for (auto other : m_entityManager.getEntities(tag))
+	{
+		if (!other->isActive() || isParked(*other)) continue;
+		Physics::Sweep s = Physics::SweptAABB(e, other);
+		if (s.hit && s.time < sweep.time)
+		{
+			sweep = s;
+			hit = other;
+		}
+	}
+	return hit;
+}
+
+//first entity with the given tag that e touches this frame, swept for fast movers so they can't tunnel
+std::shared_ptr<Entity> Scene_Play::findHit(std::shared_ptr<Entity> e, const std::string& tag)
+{
+	if (Physics::IsFast(e))
+	{
+		Physics::Sweep sweep;
+		auto hit = firstSweepHit(e, tag, sweep);
+		if (hit) return hit;
+	}
+
+	for (auto other : m_entityManager.getEntities(tag))
+	{
+		if (isParked(*other)) continue;
+		Vec2 overlap = Physics::GetOverlap(e, other);
+		if (overlap.x > 0 && overlap.y > 0) return other;
+	}
+	return nullptr;
+}
+
+//gameplay actions that netplay sends as part of the input mask
+static uint8_t inputBit(const std::string& name)
+{
+	if (name == "JUMP") return Scene_Play::INPUT_JUMP;
+	if (name == "LEFT") return Scene_Play::INPUT_LEFT;
+	if (name == "RIGHT") return Scene_Play::INPUT_RIGHT;
+	if (name == "SHOOT") return Scene_Play::INPUT_SHOOT;
+	return 0;
 }
 
 void Scene_Play::sDoAction(const Action& action)
@@ -423,8 +977,12 @@ void Scene_Play::sDoAction(const Action& action)
 		if		(action.name() == "TOGGLE_TEXTURE")		{ m_drawTextures = !m_drawTextures; }
 		else if (action.name() == "TOGGLE_COLLISION")	{ m_drawCollision = !m_drawCollision; }
 		else if (action.name() == "TOGGLE_GRID")		{ m_drawGrid = !m_drawGrid; }
-		else if (action.name() == "PAUSE")				{ setPaused(!m_paused); }
+		else if (action.name() == "TOGGLE_STATS")		{ m_drawStats = !m_drawStats; }
+		else if (action.name() == "PAUSE")				{ if (!m_session) setPaused(!m_paused); }
+		else if (action.name() == "REWIND")				{ if (!m_session) m_rewinding = true; }
+		else if (action.name() == "DUMP_MEMORY")		{ reportMemory(std::cout); }
 		else if (action.name() == "QUIT")				{ onEnd(); }
+		else if (m_session && inputBit(action.name()))	{ m_localInput |= inputBit(action.name()); }
 		else if (action.name() == "JUMP")				{ m_player->getComponent<CInput>().jump = true; }
 		else if (action.name() == "LEFT")				{ m_player->getComponent<CInput>().left = true; }
 		else if (action.name() == "RIGHT")				{ m_player->getComponent<CInput>().right = true; }
@@ -433,74 +991,185 @@ void Scene_Play::sDoAction(const Action& action)
 	}
 	else if (action.type() == "END")
 	{
-		if		(action.name() == "JUMP")				{ m_player->getComponent<CInput>().jump = false; }
+		if		(m_session && inputBit(action.name()))	{ m_localInput &= ~inputBit(action.name()); }
+		else if (action.name() == "JUMP")				{ m_player->getComponent<CInput>().jump = false; }
 		else if (action.name() == "LEFT")				{ m_player->getComponent<CInput>().left = false; }
 		else if (action.name() == "RIGHT")				{ m_player->getComponent<CInput>().right = false; }
 		else if (action.name() == "SHOOT")				{ m_player->getComponent<CInput>().shoot = false; m_player->getComponent<CInput>().canShoot = true; }
+		else if (action.name() == "REWIND")
+		{
+			m_rewinding = false;
+			std::cout << "rewind buffer: " << m_rewind.frameCount() << " frames, " << m_rewind.bytesUsed() / 1024 << " KB, "
+				<< m_rewind.averagePushMicros() << " us per capture\n";
+		}
 	}
 }
 
 void Scene_Play::sAnimation()
 {
-	auto& playerState = m_player->getComponent<CState>();
-
-	if (playerState.air) m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Air"), true);
-	else if (playerState.run) 
+	for (auto& player : m_players)
 	{
-		if (m_player->getComponent<CAnimation>().animation.getName()!="Run") m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Run"), true);
+		auto& playerState = player->getComponent<CState>();
+
+		if (playerState.air) player->addComponent<CAnimation>(getAnimation("Air"), true);
+		else if (playerState.run) 
+		{
+			if (player->getComponent<CAnimation>().animation.getName()!="Run") player->addComponent<CAnimation>(getAnimation("Run"), true);
+		}
+		else if (playerState.stand) player->addComponent<CAnimation>(getAnimation("Stand"), true);
 	}
-	else if (playerState.stand) m_player->addComponent<CAnimation>(m_game->assets().getAnimation("Stand"), true);
 	
-	for (auto e : m_entityManager.getEntities())
+	for (auto& e : m_entityManager.view<CAnimation>())
 	{
-		if (e->hasComponent<CAnimation>())
+		e->getComponent<CAnimation>().animation.update();
+		if (e->getComponent<CAnimation>().animation.hasEnded())
 		{
-			e->getComponent<CAnimation>().animation.update();
-			if (e->getComponent<CAnimation>().animation.hasEnded())
-			{
-				if(!e->getComponent<CAnimation>().repeat) e->destroy();
-			}
+			if(!e->getComponent<CAnimation>().repeat) e->destroy();
 		}
 	}
 }
 
 void Scene_Play::onEnd()
 {
+	if (isHeadless())
+	{
+		m_hasEnded = true;
+		return;
+	}
 	m_game->changeScene("MENU", std::make_shared<Scene_Menu>(m_game),true);
 }
 
+//which band of the draw order an entity's sprite goes in
+static uint8_t spriteLayer(const std::string& tag)
+{
+	if (tag == "Dec") return SpriteBatcher::LAYER_SCENERY;
+	if (tag == "Tile") return SpriteBatcher::LAYER_TILES;
+	if (tag == "Coin") return SpriteBatcher::LAYER_PICKUPS;
+	if (tag == "Enemy") return SpriteBatcher::LAYER_ENEMIES;
+	if (tag == "Player" || tag == "Player2") return SpriteBatcher::LAYER_PLAYERS;
+	if (tag == "Bullet") return SpriteBatcher::LAYER_BULLETS;
+	return SpriteBatcher::LAYER_EFFECTS;
+}
+
+//runs on the simulation thread, copies out what the next sRender will draw
+void Scene_Play::publishFrame()
+{
+	if (m_staticStale)
+	{
+		m_statics = StaticLayer::Collect(m_entityManager.getEntities());
+		m_staticStale = false;
+	}
+	else if (!m_staticPatches.empty())
+	{
+		m_statics = StaticLayer::Patch(m_statics, m_staticPatches);
+	}
+	m_staticPatches.clear();
+
+	auto& frame = m_frames.back();
+	frame.ready = true;
+	frame.paused = m_paused;
+	frame.drawTextures = m_drawTextures;
+	frame.cameraX = std::max(width() / 2.f, m_player->getComponent<CTransform>().pos.x);
+	frame.lives = m_lives;
+	frame.drawStats = m_drawStats;
+	frame.statics = m_statics;
+
+	//depth is the entity id, so sprites sharing a layer and texture keep the order they were created in
+	//anything horizontally outside the camera never reaches the batch
+	float viewLeft = frame.cameraX - width() / 2.f;
+	float viewRight = frame.cameraX + width() / 2.f;
+	frame.sprites.clear();
+	frame.drawn = 0;
+	frame.culled = 0;
+	for (auto& e : m_entityManager.view<CTransform, CAnimation>())
+	{
+		if (StaticLayer::IsStatic(*e)) continue;
+
+		auto& transform = e->getComponent<CTransform>();
+		auto& sprite = e->getComponent<CAnimation>().animation.getSprite();
+		sprite.setRotation(transform.angle);
+		sprite.setPosition(transform.pos.x, transform.pos.y);
+		sprite.setScale(transform.scale.x, transform.scale.y);
+
+		sf::FloatRect bounds = sprite.getGlobalBounds();
+		if (bounds.left > viewRight || bounds.left + bounds.width < viewLeft)
+		{
+			frame.culled++;
+			continue;
+		}
+		frame.drawn++;
+		frame.sprites.submit(spriteLayer(e->tag()), (uint32_t)e->id(), sprite);
+	}
+
+	uint32_t depth = 0;
+	for (auto& batch : m_particles.batches())
+	{
+		for (size_t i = 0; i + 4 <= batch.vertices.size(); i += 4)
+		{
+			frame.sprites.submit(SpriteBatcher::LAYER_EFFECTS, depth++, batch.texture, &batch.vertices[i]);
+		}
+	}
+	frame.sprites.sort();
+
+	m_frames.publish();
+}
+
+//runs on the render thread and only reads the latest published snapshot, never the entities
 void Scene_Play::sRender()
 {	
-	if (!m_paused) { m_game->window().clear(sf::Color(100, 100, 255)); }
-	else { m_game->window().clear(sf::Color(50, 50, 150)); }
+	m_frames.acquire();
+	const RenderSnapshot& frame = m_frames.front();
+
+	auto& renderer = this->renderer();
+	auto& target = renderer.target();
+
+	if (!frame.paused) { target.clear(sf::Color(100, 100, 255)); }
+	else { target.clear(sf::Color(50, 50, 150)); }
+
+	if (!frame.ready)
+	{
+		renderer.display();
+		return;
+	}
 
 	//set viewport of window to be centered on the player if its far enough right
-	auto& pPos = m_player->getComponent<CTransform>().pos;
-	float windowCenterX = std::max(m_game->window().getSize().x / 2.f, pPos.x);
-	sf::View view = m_game->window().getView();
-	view.setCenter(windowCenterX, m_game->window().getSize().y - view.getCenter().y);
-	m_game->window().setView(view);
+	sf::View view = target.getView();
+	view.setCenter(frame.cameraX, target.getSize().y - view.getCenter().y);
+	target.setView(view);
 
-	if (m_drawTextures)
+	if (frame.drawTextures)
 	{
-		for (auto e : m_entityManager.getEntities())
-		{
-			auto& transform = e->getComponent<CTransform>();
+		m_staticLayer.draw(renderer, frame.statics);
+		frame.sprites.draw(renderer);
+		renderer.addEntities(frame.drawn, frame.culled);
+	}
 
-			if (e->hasComponent<CAnimation>())
-			{
-				auto& animation = e->getComponent<CAnimation>().animation;
-				animation.getSprite().setRotation(transform.angle);
-				animation.getSprite().setPosition(transform.pos.x, transform.pos.y);
-				animation.getSprite().setScale(transform.scale.x, transform.scale.y);
-				m_game->window().draw(animation.getSprite());
-			}
-		}
+	//the hud bakes glyphs into the font texture, so it is built here on the thread that owns the gl context
+	if (!m_livesCounter)
+	{
+		auto livesLabel = m_hud.add<UIText>(getFont("Megaman"), 20, "Lives remaining: ");
+		livesLabel->setPosition(10, 80);
+		m_livesCounter = m_hud.add<UICounter>(getFont("Megaman"), 20, frame.lives);
+		m_livesCounter->setPosition(livesLabel->getBounds().left + livesLabel->getBounds().width, 80);
 	}
+	m_livesCounter->setValue(frame.lives);
 
-	m_livesText.setString("Lives remaining: " + std::to_string(m_lives));
-	m_livesText.setPosition(windowCenterX - m_game->window().getSize().x / 2.f +10, 80);
-	m_game->window().draw(m_livesText);
+	//counters of the frame before, this one isn't finished yet
+	if (!m_statsText)
+	{
+		m_statsText = m_hud.add<UIText>(getFont("Megaman"), 16);
+		m_statsText->setPosition(10, 110);
+	}
+	std::string stats;
+	if (frame.drawStats)
+	{
+		auto& last = renderer.lastFrame();
+		stats = "draws " + std::to_string(last.drawCalls) + "  textures " + std::to_string(last.textureChanges)
+			+ "  states " + std::to_string(last.stateChanges) + "  vertices " + std::to_string(last.vertices)
+			+ "  entities " + std::to_string(last.drawn) + " drawn / " + std::to_string(last.culled) + " culled";
+	}
+	m_statsText->setString(stats);
+	m_hud.draw(renderer);
 
 	/*if (m_drawCollision)
 	{
@@ -517,14 +1186,14 @@ void Scene_Play::sRender()
 				rect.setFillColor(sf::Color(0, 0, 0, 0));
 				rect.setOutlineColor(sf::Color(255, 255, 255, 255));
 				rect.setOutlineThickness(1);
-				m_game->window().draw(rect);
+				renderer.draw(rect);
 			}
 		}
 	}*/
 
 	/*if (m_drawGrid)
 	{
-		float leftX = m_game->window().getView().getCenter().x - width() / 2.f;
+		float leftX = target.getView().getCenter().x - width() / 2.f;
 		float rightX = leftX + width() + m_gridSize.x;
 		float nextGridX = leftX - ((int)leftX % (int)m_gridSize.x);
 
@@ -541,10 +1210,10 @@ void Scene_Play::sRender()
 				std::string yCell = std::to_string((int)y / (int)m_gridSize.y);
 				m_gridText.setString("(" + xCell + "," + yCell + ")");
 				m_gridText.setPosition(x + 3, height() - y - m_gridSize.y + 2);
-				m_game->window().draw(m_gridText);
+				renderer.draw(m_gridText);
 			}
 		}
 	}*/
 
-	m_game->window().display();
+	renderer.display();
 }
\ No newline at end of file
@@ -3,8 +3,23 @@
 #include"Scene.h"
 #include<map>
 #include<memory>
+#include<array>
+#include<atomic>
 
 #include "EntityManager.h"
+#include "RewindBuffer.h"
+#include "Physics.h"
+#include "BatchMath.h"
+#include "UI.h"
+#include "StaticLayer.h"
+#include "TripleBuffer.h"
+#include "TimerWheel.h"
+#include "ParticleSystem.h"
+#include "SpriteBatcher.h"
+#include "LevelCompiler.h"
+#include "Profiler.h"
+
+class RollbackSession;
 
 class Scene_Play : public Scene
 {
@@ -14,36 +29,147 @@ class Scene_Play : public Scene
 		std::string WEAPON;
 	};
 
+	struct EnemyConfig
+	{
+		uint8_t behaviour = CBehaviour::PATROL;
+		float sight = 0, jump = 0, gravity = 0;
+		uint32_t interval = 0;
+	};
+
+	static const size_t AI_LOD_INTERVAL = 8;	//frames between catch ups of a sleeping enemy
+
+	//everything sRender needs, written by the simulation thread and read by the render thread
+	struct RenderSnapshot
+	{
+		bool ready = false;
+		bool paused = false;
+		bool drawTextures = true;
+		float cameraX = 0;
+		int lives = 0;
+		bool drawStats = false;
+		size_t drawn = 0;		//entity sprites inside the camera
+		size_t culled = 0;		//and the ones left out
+		SpriteBatcher sprites;	//everything not in the static layer, sorted and ready to draw
+		std::shared_ptr<const StaticLayer::Items> statics;
+	};
+
+public:
+	enum InputBits : uint8_t
+	{
+		INPUT_JUMP	= 1 << 0,
+		INPUT_LEFT	= 1 << 1,
+		INPUT_RIGHT	= 1 << 2,
+		INPUT_SHOOT	= 1 << 3
+	};
+
 protected:
-	std::shared_ptr<Entity> m_player;
+	std::shared_ptr<Entity> m_player;	//the local player, followed by the camera
+	std::vector<std::shared_ptr<Entity>> m_players;
+	size_t m_localPlayer = 0;
+	std::shared_ptr<RollbackSession> m_session;
+	uint8_t m_localInput = 0;
 	std::string m_levelPath;
 	PlayerConfig m_playerConfig;
+	std::map<std::string, size_t> m_levelEntities;	//level file entry -> id of the entity it spawned
+	LevelCompiler::Stats m_levelStats;
+	Profiler* m_profiler = nullptr;
+	TimerWheel<std::weak_ptr<Entity>> m_expiries;	//entities with a lifespan, keyed by the frame it runs out
+	std::vector<std::weak_ptr<Entity>> m_expired;
+	std::map<std::string, EnemyConfig> m_enemyTypes;	//keyed by the animation name enemy entries use
+	Physics::World m_physics;		//players and enemies against the tiles
+	EntityVector m_physicsBodies;	//bodies stepped this frame
+	bool m_tileColumnsStale = true;		//the world's tile columns are rebuilt before the next step
+	std::array<EntityVector, 3> m_aiBatches;		//awake enemies grouped by behaviour type
 	bool m_drawTextures = true;
 	bool m_drawCollision = false;
 	bool m_drawGrid = false;
+	bool m_drawStats = false;
 	int m_lives = 3;
 	const Vec2 m_gridSize = { 64,64 };
 	sf::Text m_gridText;
-	sf::Text m_livesText;
 
-	void init(const std::string& levelPath);
+	ParticleSystem m_particles;
+	TripleBuffer<RenderSnapshot> m_frames;
+	std::shared_ptr<const StaticLayer::Items> m_statics;
+	bool m_staticStale = true;	//static scenery changed, collected again before the next publish
+	EntityVector m_staticPatches;	//single tiles that changed, patched into m_statics at the next publish
+
+	//render thread only
+	UILayer m_hud;
+	std::shared_ptr<UICounter> m_livesCounter;
+	std::shared_ptr<UIText> m_statsText;
+	StaticLayer m_staticLayer;
+
+	RewindBuffer m_rewind;
+	NameTable m_names;
+	WorldState m_worldState;
+	bool m_rewinding = false;
+	bool m_recording = true;
+
+	static const size_t SPAWN_CHUNK = 256;	//level entries per command buffer slot while loading
 
-	void loadLevel(const std::string& filename);
+	BatchMath::Bodies m_bodies;	//scratch arrays for sMovement, kept to avoid reallocating every frame
+	std::vector<Entity*> m_movers;	//entity behind each slot of m_bodies
+
+	void init(const std::string& levelPath, std::atomic<float>* progress = nullptr);
+
+	void loadLevel(const std::string& filename, std::atomic<float>* progress = nullptr);
+	void reloadLevel();
+	std::vector<std::string> readLevel(const std::string& filename);
+	std::shared_ptr<Entity> spawnLevelEntry(const std::string& entry, CommandBuffer* commands = nullptr);
 	Vec2 gridToMidPixel(float gridX, float gridY, std::shared_ptr<Entity> entity);
 
-	void spawnPlayer();
+	void spawnPlayer(size_t index);
 	void spawnBullet(std::shared_ptr<Entity> entity);
+	void setLifespan(std::shared_ptr<Entity> entity, int frames);
+	void hitBlockFromBelow(std::shared_ptr<Entity> tile);
+	void invalidateTile(std::shared_ptr<Entity> tile);
+	void explode(std::shared_ptr<Entity> e);
+
+	std::shared_ptr<Entity> findHit(std::shared_ptr<Entity> e, const std::string& tag);
+	std::shared_ptr<Entity> firstSweepHit(std::shared_ptr<Entity> e, const std::string& tag, Physics::Sweep& sweep);
 
 	void update();
 	void sDoAction(const Action& action);
+	void sAI();
+	void thinkEnemy(std::shared_ptr<Entity> enemy, float playerDx);
+	void collideEnemy(std::shared_ptr<Entity> enemy);
+	void enemyContacts(std::shared_ptr<Entity> enemy);
+	void sleepEnemy(std::shared_ptr<Entity> enemy);
+	void replayEnemy(std::shared_ptr<Entity> enemy);
+	void wakeEnemy(std::shared_ptr<Entity> enemy);
+	void settleSleepers(const Entity& tile);
+	float nearestPlayerDx(const Entity& e) const;
 	void sMovement();
+	void sPlayerMovement(std::shared_ptr<Entity> player);
 	void sCollision();
+	void sPlayerCollision(std::shared_ptr<Entity> player, size_t index);
 	void sLifespan();
 	void sAnimation();
 	void sRender();
+	void publishFrame();
+	void sRecord();
+	void sRewind();
 
 	void onEnd();
 
 public:
-	Scene_Play(GameEngine* gameEngine, const std::string& levelPath);
+	void reportMemory(std::ostream& out);
+	void onAssetsReloaded(const std::set<std::string>& animations);
+	void onFileChanged(const std::string& path);
+	void setRecording(bool recording);
+	void setProfiler(Profiler* profiler);
+	void step();
+	void setInputMask(size_t playerIndex, uint8_t mask);
+	void captureState(WorldState& state);
+	void restoreState(const WorldState& state);
+	void startNetplay(size_t localPlayer, unsigned short localPort, const std::string& remoteAddress, unsigned short remotePort);
+	std::shared_ptr<RollbackSession> session();
+	int lives() const;
+	std::shared_ptr<Entity> player();
+	EntityManager& entities();
+	const Vec2& gridSize() const;
+
+	Scene_Play(GameEngine* gameEngine, const std::string& levelPath, size_t playerCount = 1, std::atomic<float>* progress = nullptr);
+	Scene_Play(const Assets& assets, const std::string& levelPath, size_t playerCount = 1);
 };
\ No newline at end of file
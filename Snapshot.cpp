@@ -0,0 +1,273 @@
+#include "Snapshot.h"
+#include "Scene.h"
+
+#include<cstring>
+
+static_assert(sizeof(EntityRecord) == 112, "EntityRecord must not contain padding");
+
+enum ComponentBits : uint8_t
+{
+	BIT_TRANSFORM	= 1 << 0,
+	BIT_LIFESPAN	= 1 << 1,
+	BIT_INPUT		= 1 << 2,
+	BIT_BOUNDINGBOX	= 1 << 3,
+	BIT_ANIMATION	= 1 << 4,
+	BIT_GRAVITY		= 1 << 5,
+	BIT_STATE		= 1 << 6,
+	BIT_BEHAVIOUR	= 1 << 7
+};
+
+enum FlagBits : uint8_t
+{
+	FLAG_ACTIVE		= 1 << 0,
+	FLAG_PENDING	= 1 << 1,
+	FLAG_REPEAT		= 1 << 2
+};
+
+enum AIFlagBits : uint8_t
+{
+	AI_GROUNDED		= 1 << 0,
+	AI_ASLEEP		= 1 << 1
+};
+
+NameTable::NameTable()
+{
+	intern("none");
+}
+
+uint16_t NameTable::intern(const std::string& name)
+{
+	auto it = m_ids.find(name);
+	if (it != m_ids.end()) return it->second;
+
+	uint16_t id = (uint16_t)m_names.size();
+	m_names.push_back(name);
+	m_ids[name] = id;
+	return id;
+}
+
+const std::string& NameTable::name(uint16_t id) const
+{
+	assert(id < m_names.size());
+	return m_names[id];
+}
+
+static void captureEntity(const Entity& e, bool pending, NameTable& names, EntityRecord& r)
+{
+	std::memset(&r, 0, sizeof(r));
+	r.id = (uint32_t)e.id();
+	r.tag = names.intern(e.tag());
+	if (e.isActive()) r.flags |= FLAG_ACTIVE;
+	if (pending) r.flags |= FLAG_PENDING;
+
+	if (e.hasComponent<CTransform>())
+	{
+		auto& t = e.getComponent<CTransform>();
+		r.components |= BIT_TRANSFORM;
+		r.pos[0] = t.pos.x;				r.pos[1] = t.pos.y;
+		r.prevPos[0] = t.prevPos.x;		r.prevPos[1] = t.prevPos.y;
+		r.scale[0] = t.scale.x;			r.scale[1] = t.scale.y;
+		r.velocity[0] = t.velocity.x;	r.velocity[1] = t.velocity.y;
+		r.angle = t.angle;
+	}
+	if (e.hasComponent<CLifespan>())
+	{
+		auto& l = e.getComponent<CLifespan>();
+		r.components |= BIT_LIFESPAN;
+		r.lifespan = l.lifespan;
+		r.frameCreated = (uint32_t)l.frameCreated;
+	}
+	if (e.hasComponent<CInput>())
+	{
+		auto& i = e.getComponent<CInput>();
+		r.components |= BIT_INPUT;
+		r.input = (i.jump << 0) | (i.left << 1) | (i.right << 2) | (i.shoot << 3) | (i.canShoot << 4);
+	}
+	if (e.hasComponent<CBoundingBox>())
+	{
+		auto& b = e.getComponent<CBoundingBox>();
+		r.components |= BIT_BOUNDINGBOX;
+		r.boundingBox[0] = b.size.x;	r.boundingBox[1] = b.size.y;
+	}
+	if (e.hasComponent<CAnimation>())
+	{
+		auto& a = e.getComponent<CAnimation>();
+		r.components |= BIT_ANIMATION;
+		r.animation = names.intern(a.animation.getName());
+		r.animationFrame = (uint32_t)a.animation.getCurrentFrame();
+		if (a.repeat) r.flags |= FLAG_REPEAT;
+	}
+	if (e.hasComponent<CGravity>())
+	{
+		r.components |= BIT_GRAVITY;
+		r.gravity = e.getComponent<CGravity>().gravity;
+	}
+	if (e.hasComponent<CState>())
+	{
+		auto& s = e.getComponent<CState>();
+		r.components |= BIT_STATE;
+		r.state = (s.stand << 0) | (s.run << 1) | (s.air << 2);
+	}
+	if (e.hasComponent<CBehaviour>())
+	{
+		auto& b = e.getComponent<CBehaviour>();
+		r.components |= BIT_BEHAVIOUR;
+		r.behaviour = b.type;
+		r.aiFlags = (b.grounded ? AI_GROUNDED : 0) | (b.asleep ? AI_ASLEEP : 0);
+		r.jumpInterval = b.interval;
+		r.jumpTimer = b.timer;
+		r.aiFrame = (uint32_t)b.frame;
+		r.speed = b.speed;
+		r.sight = b.sight;
+		r.jump = b.jump;
+		r.sleepVelocity[0] = b.sleepVelocity.x;	r.sleepVelocity[1] = b.sleepVelocity.y;
+		r.sleepGravity = b.sleepGravity;
+	}
+}
+
+//writes a record back over an entity, components the record doesn't have are removed and an animation that is
+//already the right one only has its frame set, so patching an entity doesn't look anything up
+static void restoreEntity(const EntityRecord& r, Entity& e, const Scene& scene, const NameTable& names)
+{
+	if (r.components & BIT_TRANSFORM)
+	{
+		auto& t = e.addComponent<CTransform>();
+		t.pos = Vec2(r.pos[0], r.pos[1]);
+		t.prevPos = Vec2(r.prevPos[0], r.prevPos[1]);
+		t.scale = Vec2(r.scale[0], r.scale[1]);
+		t.velocity = Vec2(r.velocity[0], r.velocity[1]);
+		t.angle = r.angle;
+	}
+	else if (e.hasComponent<CTransform>()) e.removeComponent<CTransform>();
+	if (r.components & BIT_LIFESPAN)
+	{
+		e.addComponent<CLifespan>(r.lifespan, r.frameCreated);
+	}
+	else if (e.hasComponent<CLifespan>()) e.removeComponent<CLifespan>();
+	if (r.components & BIT_INPUT)
+	{
+		auto& i = e.addComponent<CInput>();
+		i.jump = (r.input >> 0) & 1;
+		i.left = (r.input >> 1) & 1;
+		i.right = (r.input >> 2) & 1;
+		i.shoot = (r.input >> 3) & 1;
+		i.canShoot = (r.input >> 4) & 1;
+	}
+	else if (e.hasComponent<CInput>()) e.removeComponent<CInput>();
+	if (r.components & BIT_BOUNDINGBOX)
+	{
+		e.addComponent<CBoundingBox>(Vec2(r.boundingBox[0], r.boundingBox[1]));
+	}
+	else if (e.hasComponent<CBoundingBox>()) e.removeComponent<CBoundingBox>();
+	if (r.components & BIT_ANIMATION)
+	{
+		const std::string& name = names.name(r.animation);
+		if (!e.hasComponent<CAnimation>() || e.getComponent<CAnimation>().animation.getName() != name)
+		{
+			e.addComponent<CAnimation>(scene.getAnimation(name), false);
+		}
+		auto& a = e.getComponent<CAnimation>();
+		a.repeat = (r.flags & FLAG_REPEAT) != 0;
+		a.animation.setCurrentFrame(r.animationFrame);
+	}
+	else if (e.hasComponent<CAnimation>()) e.removeComponent<CAnimation>();
+	if (r.components & BIT_GRAVITY)
+	{
+		e.addComponent<CGravity>(r.gravity);
+	}
+	else if (e.hasComponent<CGravity>()) e.removeComponent<CGravity>();
+	if (r.components & BIT_STATE)
+	{
+		auto& s = e.addComponent<CState>();
+		s.stand = (r.state >> 0) & 1;
+		s.run = (r.state >> 1) & 1;
+		s.air = (r.state >> 2) & 1;
+	}
+	else if (e.hasComponent<CState>()) e.removeComponent<CState>();
+	if (r.components & BIT_BEHAVIOUR)
+	{
+		auto& b = e.addComponent<CBehaviour>((uint8_t)r.behaviour, r.speed, r.sight, r.jump, r.jumpInterval);
+		b.timer = r.jumpTimer;
+		b.grounded = (r.aiFlags & AI_GROUNDED) != 0;
+		b.asleep = (r.aiFlags & AI_ASLEEP) != 0;
+		b.frame = r.aiFrame;
+		b.sleepVelocity = Vec2(r.sleepVelocity[0], r.sleepVelocity[1]);
+		b.sleepGravity = r.sleepGravity;
+	}
+	else if (e.hasComponent<CBehaviour>()) e.removeComponent<CBehaviour>();
+}
+
+//records live entities followed by the ones still waiting in the add list, both are in id order
+void Snapshot::Capture(EntityManager& entities, NameTable& names, WorldState& state)
+{
+	state.totalEntities = entities.totalEntities();
+	state.entities.resize(entities.getEntities().size() + entities.getPendingEntities().size());
+
+	size_t i = 0;
+	for (auto& e : entities.getEntities()) captureEntity(*e, false, names, state.entities[i++]);
+	for (auto& e : entities.getPendingEntities()) captureEntity(*e, true, names, state.entities[i++]);
+}
+
+//entities still in the state they were saved in are left alone and the rest are patched in place, only entities
+//created or removed since are rebuilt, so tiles cost a compare rather than an allocation and an asset lookup each
+void Snapshot::Restore(const WorldState& state, EntityManager& entities, const Scene& scene, NameTable& names, std::set<std::string>& changed)
+{
+	std::unordered_map<size_t, std::shared_ptr<Entity>> current;
+	current.reserve(entities.getEntities().size() + entities.getPendingEntities().size());
+	for (auto& e : entities.getEntities()) current[e->id()] = e;
+	for (auto& e : entities.getPendingEntities()) current[e->id()] = e;
+
+	EntityVector live, pending;
+	live.reserve(state.entities.size());
+	EntityRecord now;
+	for (auto& r : state.entities)
+	{
+		const bool isPending = (r.flags & FLAG_PENDING) != 0;
+		bool differs = true;
+		std::shared_ptr<Entity> e;
+		auto it = current.find(r.id);
+		if (it != current.end() && it->second->tag() == names.name(r.tag))
+		{
+			e = it->second;
+			current.erase(it);
+			captureEntity(*e, isPending, names, now);
+			differs = std::memcmp(&now, &r, sizeof(r)) != 0;
+		}
+		else
+		{
+			e = entities.restoreEntity(names.name(r.tag), r.id);
+		}
+
+		if (differs)
+		{
+			entities.setActive(*e, (r.flags & FLAG_ACTIVE) != 0);
+			restoreEntity(r, *e, scene, names);
+			changed.insert(e->tag());
+		}
+		(isPending ? pending : live).push_back(e);
+	}
+
+	//whatever is left was created after the state was saved
+	for (auto& p : current) changed.insert(p.second->tag());
+	entities.restore(live, pending, state.totalEntities);
+}
+
+//FNV-1a over the frame counters and every record, records have no padding so this is stable
+uint64_t Snapshot::Hash(const WorldState& state)
+{
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](const void* data, size_t size)
+	{
+		auto bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	};
+
+	uint64_t header[3] = { state.frame, (uint64_t)(int64_t)state.lives, state.totalEntities };
+	mix(header, sizeof(header));
+	if (!state.entities.empty()) mix(state.entities.data(), state.entities.size() * sizeof(EntityRecord));
+	return hash;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "EntityManager.h"
+
+#include<cstdint>
+#include<set>
+#include<unordered_map>
+
+class Scene;
+
+//flat, fixed size copy of one entity, strings are replaced by ids from a NameTable
+//every field is explicit so two records can be compared with memcmp
+struct EntityRecord
+{
+	uint32_t id;
+	uint16_t tag;
+	uint16_t animation;
+	uint32_t animationFrame;
+	uint8_t components;	//one bit per component the entity has
+	uint8_t flags;		//active, pending, animation repeat
+	uint8_t input;		//packed CInput bools
+	uint8_t state;		//packed CState bools
+
+	float pos[2];
+	float prevPos[2];
+	float scale[2];
+	float velocity[2];
+	float angle;
+
+	int32_t lifespan;
+	uint32_t frameCreated;
+
+	float boundingBox[2];
+	float gravity;
+
+	uint16_t behaviour;	//16 bits so jumpInterval is aligned without padding
+	uint16_t aiFlags;	//grounded, asleep
+	uint32_t jumpInterval;
+	uint32_t jumpTimer;
+	uint32_t aiFrame;
+	float speed;
+	float sight;
+	float jump;
+	float sleepVelocity[2];
+	float sleepGravity;
+};
+
+//everything needed to put a Scene_Play back to the exact same frame
+struct WorldState
+{
+	size_t frame;
+	int lives;
+	size_t totalEntities;
+	std::vector<EntityRecord> entities; //sorted by id
+};
+
+class NameTable
+{
+	std::vector<std::string> m_names;
+	std::unordered_map<std::string, uint16_t> m_ids;
+
+public:
+
+	NameTable();
+
+	uint16_t intern(const std::string& name);
+	const std::string& name(uint16_t id) const;
+};
+
+namespace Snapshot
+{
+	void Capture(EntityManager& entities, NameTable& names, WorldState& state);
+	//changed gets the tag of every entity that had to be patched, added or removed
+	void Restore(const WorldState& state, EntityManager& entities, const Scene& scene, NameTable& names, std::set<std::string>& changed);
+	uint64_t Hash(const WorldState& state);
+};
@@ -0,0 +1,112 @@
+#include "SpriteBatcher.h"
+
+#include<algorithm>
+#include<array>
+#include<cstdlib>
+
+void SpriteBatcher::clear()
+{
+	m_entries.clear();
+	m_quads.clear();
+	m_textures.clear();
+	m_batches.clear();
+}
+
+//a handful of textures per frame, a linear search beats hashing
+uint32_t SpriteBatcher::textureId(const sf::Texture* texture)
+{
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		if (m_textures[i] == texture) return (uint32_t)i;
+	}
+	m_textures.push_back(texture);
+	return (uint32_t)(m_textures.size() - 1);
+}
+
+//the sprite's transform is baked into the quad, so it draws exactly like sf::Sprite would
+void SpriteBatcher::submit(uint8_t layer, uint32_t depth, const sf::Sprite& sprite)
+{
+	const sf::IntRect& rect = sprite.getTextureRect();
+	const sf::Transform& transform = sprite.getTransform();
+	float width = (float)std::abs(rect.width);
+	float height = (float)std::abs(rect.height);
+	float left = (float)rect.left, right = left + rect.width;
+	float top = (float)rect.top, bottom = top + rect.height;
+
+	sf::Vertex quad[4] =
+	{
+		sf::Vertex(transform.transformPoint(0, 0), sprite.getColor(), sf::Vector2f(left, top)),
+		sf::Vertex(transform.transformPoint(width, 0), sprite.getColor(), sf::Vector2f(right, top)),
+		sf::Vertex(transform.transformPoint(width, height), sprite.getColor(), sf::Vector2f(right, bottom)),
+		sf::Vertex(transform.transformPoint(0, height), sprite.getColor(), sf::Vector2f(left, bottom))
+	};
+	submit(layer, depth, sprite.getTexture(), quad);
+}
+
+void SpriteBatcher::submit(uint8_t layer, uint32_t depth, const sf::Texture* texture, const sf::Vertex* quad)
+{
+	uint64_t key = (uint64_t)layer << 56 | (uint64_t)(textureId(texture) & 0xffffff) << 32 | depth;
+	m_entries.push_back({ key, (uint32_t)(m_quads.size() / 4) });
+	m_quads.insert(m_quads.end(), quad, quad + 4);
+}
+
+//lsd radix sort on the key a byte at a time, stable so equal keys keep submission order,
+//bytes every key shares (most of the layer and texture bits) cost one counting pass and no scatter
+void SpriteBatcher::radixSort()
+{
+	m_scratch.resize(m_entries.size());
+	for (int shift = 0; shift < 64; shift += 8)
+	{
+		std::array<size_t, 256> counts = {};
+		for (auto& e : m_entries) counts[(e.key >> shift) & 0xff]++;
+		if (counts[(m_entries[0].key >> shift) & 0xff] == m_entries.size()) continue;
+
+		size_t offset = 0;
+		for (auto& c : counts)
+		{
+			size_t count = c;
+			c = offset;
+			offset += count;
+		}
+		for (auto& e : m_entries) m_scratch[counts[(e.key >> shift) & 0xff]++] = e;
+		m_entries.swap(m_scratch);
+	}
+}
+
+//orders the quads and splits them into one batch per run of the same texture
+void SpriteBatcher::sort()
+{
+	m_batches.clear();
+	m_sorted.resize(m_quads.size());
+	if (m_entries.empty()) return;
+
+	radixSort();
+
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		auto& e = m_entries[i];
+		std::copy(m_quads.begin() + e.quad * 4, m_quads.begin() + e.quad * 4 + 4, m_sorted.begin() + i * 4);
+
+		const sf::Texture* texture = m_textures[(e.key >> 32) & 0xffffff];
+		if (m_batches.empty() || m_batches.back().texture != texture) m_batches.push_back({ texture, i * 4, 0 });
+		m_batches.back().count += 4;
+	}
+}
+
+void SpriteBatcher::draw(RenderStats& target) const
+{
+	for (auto& batch : m_batches)
+	{
+		target.draw(m_sorted.data() + batch.first, batch.count, sf::Quads, sf::RenderStates(batch.texture));
+	}
+}
+
+size_t SpriteBatcher::quadCount() const
+{
+	return m_entries.size();
+}
+
+size_t SpriteBatcher::batchCount() const
+{
+	return m_batches.size();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "RenderStats.h"
+
+#include<SFML/Graphics.hpp>
+#include<vector>
+#include<cstdint>
+
+//render queue for one frame: every sprite goes in as a 64 bit sort key and a quad,
+//after sorting, runs of quads sharing a texture are drawn with a single call
+//key bits: layer 8 | texture 24 | depth 32, so inside a layer quads are grouped by texture
+//and depth only orders quads that share one
+class SpriteBatcher
+{
+public:
+
+	//back to front
+	enum Layer : uint8_t
+	{
+		LAYER_SCENERY,
+		LAYER_TILES,
+		LAYER_PICKUPS,
+		LAYER_ENEMIES,
+		LAYER_PLAYERS,
+		LAYER_BULLETS,
+		LAYER_EFFECTS
+	};
+
+private:
+
+	struct Entry
+	{
+		uint64_t key;
+		uint32_t quad;	//index of the quad's first vertex in m_quads / 4
+	};
+
+	struct Batch
+	{
+		const sf::Texture* texture;
+		size_t first, count;	//vertices in m_sorted
+	};
+
+	std::vector<Entry> m_entries, m_scratch;
+	std::vector<sf::Vertex> m_quads;	//in submission order
+	std::vector<sf::Vertex> m_sorted;	//in draw order
+	std::vector<const sf::Texture*> m_textures;	//key texture id -> texture, in order of first use this frame
+	std::vector<Batch> m_batches;
+
+	uint32_t textureId(const sf::Texture* texture);
+	void radixSort();
+
+public:
+
+	void clear();
+	void submit(uint8_t layer, uint32_t depth, const sf::Sprite& sprite);
+	void submit(uint8_t layer, uint32_t depth, const sf::Texture* texture, const sf::Vertex* quad);
+	void sort();
+	void draw(RenderStats& target) const;
+
+	size_t quadCount() const;
+	size_t batchCount() const;
+};
\ No newline at end of file
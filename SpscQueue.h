@@ -0,0 +1,47 @@
+#pragma once
+
+#include<array>
+#include<atomic>
+#include<cstddef>
+#include<utility>
+
+//lock free ring between exactly one producer thread and one consumer thread
+//push fails rather than overwriting when the consumer has fallen a whole ring behind
+template<typename T, size_t N>
+class SpscQueue
+{
+	static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+	std::array<T, N> m_items;
+	alignas(64) std::atomic<size_t> m_head{ 0 };	//next slot to read, only the consumer moves it
+	alignas(64) std::atomic<size_t> m_tail{ 0 };	//next slot to write, only the producer moves it
+
+public:
+
+	//producer side
+	bool push(T item)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == N) return false;
+
+		m_items[tail & (N - 1)] = std::move(item);
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	//consumer side, the oldest item or null when empty, stays valid until pop
+	T* front()
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire)) return nullptr;
+		return &m_items[head & (N - 1)];
+	}
+
+	//clears the slot first so the queue doesn't keep what the item referred to alive
+	void pop()
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		m_items[head & (N - 1)] = T();
+		m_head.store(head + 1, std::memory_order_release);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,192 @@
+#include "StaticLayer.h"
+
+#include<algorithm>
+#include<atomic>
+#include<cmath>
+#include<functional>
+#include<limits>
+
+bool StaticLayer::IsStatic(const Entity& e)
+{
+	if (!e.hasComponent<CAnimation>() || e.getComponent<CAnimation>().animation.getFrameCount() > 1) return false;
+	return e.tag() == "Tile" || e.tag() == "Dec";
+}
+
+StaticLayer::Item StaticLayer::MakeItem(const Entity& e)
+{
+	auto& transform = e.getComponent<CTransform>();
+	auto& animation = e.getComponent<CAnimation>().animation;
+	Item item;
+	item.id = e.id();
+	item.animation = std::hash<std::string>()(animation.getName());
+	item.left = transform.pos.x - animation.getSize().x / 2.f;
+	item.right = transform.pos.x + animation.getSize().x / 2.f;
+	item.sprite = animation.getSprite();
+	item.sprite.setRotation(transform.angle);
+	item.sprite.setPosition(transform.pos.x, transform.pos.y);
+	item.sprite.setScale(transform.scale.x, transform.scale.y);
+	return item;
+}
+
+//snapshots every live static entity, the list is immutable once built so the render thread can keep it
+std::shared_ptr<const StaticLayer::Items> StaticLayer::Collect(const EntityVector& entities)
+{
+	static std::atomic<size_t> generations(0);
+
+	auto items = std::make_shared<Items>();
+	items->generation = ++generations;
+	for (auto& e : entities)
+	{
+		if (e->isActive() && IsStatic(*e)) items->items.push_back(MakeItem(*e));
+	}
+	return items;
+}
+
+//each change covers where the item was and where it is now, so a broken brick only rebakes the chunks under it
+std::shared_ptr<const StaticLayer::Items> StaticLayer::Patch(const std::shared_ptr<const Items>& items, const EntityVector& entities)
+{
+	auto patched = std::make_shared<Items>(*items);
+	auto& list = patched->items;
+	for (auto& e : entities)
+	{
+		float left = std::numeric_limits<float>::infinity(), right = -left;
+		auto it = std::lower_bound(list.begin(), list.end(), e->id(), [](const Item& item, size_t id) { return item.id < id; });
+		if (it != list.end() && it->id == e->id())
+		{
+			left = it->left;
+			right = it->right;
+			it = list.erase(it);
+		}
+		if (e->isActive() && IsStatic(*e))
+		{
+			it = list.insert(it, MakeItem(*e));
+			left = std::min(left, it->left);
+			right = std::max(right, it->right);
+		}
+		if (left <= right) patched->changes.emplace_back(left, right);
+	}
+	return patched;
+}
+
+int StaticLayer::chunkIndex(float x) const
+{
+	return (int)std::floor(x / m_size.x);
+}
+
+bool StaticLayer::overlaps(int index, const Item& item) const
+{
+	return item.right > index * (float)m_size.x && item.left < (index + 1) * (float)m_size.x;
+}
+
+size_t StaticLayer::fingerprint(int index) const
+{
+	size_t hash = 0;
+	for (auto& item : m_items->items)
+	{
+		if (!overlaps(index, item)) continue;
+		hash = hash * 31 + item.id;
+		hash = hash * 31 + item.animation;
+	}
+	return hash;
+}
+
+//every chunk's fingerprint in one pass over the items, a chunk whose contents differ from what it baked is dirty
+void StaticLayer::refingerprint()
+{
+	std::map<int, size_t> hashes;
+	for (auto& c : m_chunks) hashes[c.first] = 0;
+	for (auto& item : m_items->items)
+	{
+		for (int i = chunkIndex(item.left); i <= chunkIndex(item.right); i++)
+		{
+			auto it = hashes.find(i);
+			if (it == hashes.end() || !overlaps(i, item)) continue;
+			it->second = it->second * 31 + item.id;
+			it->second = it->second * 31 + item.animation;
+		}
+	}
+	for (auto& c : m_chunks)
+	{
+		if (c.second->fingerprint != hashes[c.first]) c.second->dirty = true;
+	}
+}
+
+void StaticLayer::invalidateRange(float left, float right)
+{
+	for (int i = chunkIndex(left); i <= chunkIndex(right); i++)
+	{
+		auto it = m_chunks.find(i);
+		if (it != m_chunks.end()) it->second->dirty = true;
+	}
+}
+
+void StaticLayer::bake(int index, Chunk& chunk)
+{
+	chunk.texture.clear(sf::Color::Transparent);
+	chunk.texture.setView(sf::View(sf::FloatRect(index * (float)m_size.x, 0.f, (float)m_size.x, (float)m_size.y)));
+
+	for (auto& item : m_items->items)
+	{
+		if (overlaps(index, item)) chunk.texture.draw(item.sprite);
+	}
+
+	chunk.texture.display();
+	chunk.fingerprint = fingerprint(index);
+	chunk.dirty = false;
+}
+
+void StaticLayer::invalidateAll()
+{
+	for (auto& c : m_chunks) c.second->dirty = true;
+}
+
+//draws the chunks under the target's current view, baking any that are new or whose contents changed
+void StaticLayer::draw(RenderStats& renderer, const std::shared_ptr<const Items>& items)
+{
+	auto& target = renderer.target();
+	if (!items) return;
+
+	if (m_size != target.getSize())
+	{
+		m_size = target.getSize();
+		m_chunks.clear();
+	}
+
+	//a patched list says where it changed, a freshly collected one could differ anywhere so the fingerprints narrow
+	//it down to the chunks involved, frames the render side never saw still have their changes in the list
+	if (items != m_items)
+	{
+		bool patched = m_items && items->generation == m_items->generation && items->changes.size() >= m_applied;
+		size_t from = patched ? m_applied : items->changes.size();
+		m_items = items;
+		m_applied = items->changes.size();
+		if (!patched) refingerprint();
+		for (size_t i = from; i < items->changes.size(); i++) invalidateRange(items->changes[i].first, items->changes[i].second);
+	}
+
+	const sf::View& view = target.getView();
+	int first = chunkIndex(view.getCenter().x - view.getSize().x / 2.f);
+	int last = chunkIndex(view.getCenter().x + view.getSize().x / 2.f);
+
+	//sprites were blended into a transparent texture, so the chunks go on premultiplied
+	sf::RenderStates states(sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha));
+	for (int i = first; i <= last; i++)
+	{
+		auto& chunk = m_chunks[i];
+		if (!chunk)
+		{
+			chunk = std::make_unique<Chunk>();
+			chunk->texture.create(m_size.x, m_size.y);
+			chunk->sprite.setTexture(chunk->texture.getTexture(), true);
+			chunk->sprite.setPosition(i * (float)m_size.x, 0.f);
+		}
+		if (chunk->dirty) bake(i, *chunk);
+		renderer.draw(chunk->sprite, states);
+	}
+
+	for (auto it = m_chunks.begin(); it != m_chunks.end();)
+	{
+		if (it->first < first - KEEP_CHUNKS || it->first > last + KEEP_CHUNKS) it = m_chunks.erase(it);
+		else ++it;
+	}
+}
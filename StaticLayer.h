@@ -0,0 +1,68 @@
+#pragma once
+
+#include "EntityManager.h"
+#include "RenderStats.h"
+
+#include<SFML/Graphics.hpp>
+#include<map>
+#include<memory>
+
+//tiles and decorations that never animate, pre-rendered into screen sized chunks
+//a frame composites the one or two chunks the camera overlaps instead of drawing every sprite
+class StaticLayer
+{
+public:
+
+	//a static entity as the render side sees it, collected on the simulation side
+	struct Item
+	{
+		size_t id;
+		size_t animation;	//hash of the animation name, a question block flipping changes it
+		float left, right;
+		sf::Sprite sprite;
+	};
+
+	//a published list, changes are the x-ranges Patch touched since the Collect it came from
+	struct Items
+	{
+		std::vector<Item> items;	//in id order
+		std::vector<std::pair<float, float>> changes;
+		size_t generation = 0;		//which Collect this list descends from
+	};
+
+private:
+
+	struct Chunk
+	{
+		sf::RenderTexture texture;
+		sf::Sprite sprite;
+		size_t fingerprint = 0;	//what was baked, compared when a new item list arrives
+		bool dirty = true;
+	};
+
+	static const int KEEP_CHUNKS = 2;	//chunks further than this from the camera give their texture back
+
+	std::map<int, std::unique_ptr<Chunk>> m_chunks;
+	std::shared_ptr<const Items> m_items;
+	size_t m_applied = 0;	//changes of m_items already marked dirty
+	sf::Vector2u m_size;
+
+	static Item MakeItem(const Entity& e);
+
+	int chunkIndex(float x) const;
+	bool overlaps(int index, const Item& item) const;
+	size_t fingerprint(int index) const;
+	void refingerprint();
+	void invalidateRange(float left, float right);
+	void bake(int index, Chunk& chunk);
+
+public:
+
+	static bool IsStatic(const Entity& e);
+	static std::shared_ptr<const Items> Collect(const EntityVector& entities);
+	//a copy of items with these entities' items replaced, added or dropped, for a tile that broke or changed
+	static std::shared_ptr<const Items> Patch(const std::shared_ptr<const Items>& items, const EntityVector& entities);
+
+	void invalidateAll();
+	void draw(RenderStats& renderer, const std::shared_ptr<const Items>& items);
+};
\ No newline at end of file
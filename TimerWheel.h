@@ -0,0 +1,85 @@
+#pragma once
+
+#include<array>
+#include<cstddef>
+#include<vector>
+
+//hierarchical timing wheel keyed by frame: scheduling is constant time and advancing one frame only
+//touches what fires that frame, plus one slot of a coarser wheel every time a finer one wraps around
+//three wheels of 256 slots reach 16M frames ahead, anything further waits in an overflow list
+template<typename T>
+class TimerWheel
+{
+	static const size_t SLOT_BITS = 8;
+	static const size_t SLOTS = size_t(1) << SLOT_BITS;
+	static const size_t LEVELS = 3;
+
+	struct Timer
+	{
+		size_t frame;
+		T payload;
+	};
+
+	std::array<std::array<std::vector<Timer>, SLOTS>, LEVELS> m_wheels;
+	std::vector<Timer> m_overflow;
+	size_t m_now = 0;	//frame the next advance fires
+
+	//the finest wheel whose lap the frame shares with now
+	void place(Timer&& timer)
+	{
+		for (size_t level = 0; level < LEVELS; level++)
+		{
+			if (((timer.frame ^ m_now) >> (SLOT_BITS * (level + 1))) == 0)
+			{
+				m_wheels[level][(timer.frame >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(std::move(timer));
+				return;
+			}
+		}
+		m_overflow.push_back(std::move(timer));
+	}
+
+	void cascade(std::vector<Timer>& timers)
+	{
+		std::vector<Timer> moving;
+		moving.swap(timers);
+		for (auto& t : moving) place(std::move(t));
+	}
+
+public:
+
+	//drops every timer, the next advance fires the given frame
+	void reset(size_t frame)
+	{
+		for (auto& wheel : m_wheels) { for (auto& slot : wheel) slot.clear(); }
+		m_overflow.clear();
+		m_now = frame;
+	}
+
+	//a frame that has already gone fires on the next advance
+	void schedule(size_t frame, T payload)
+	{
+		place({ frame < m_now ? m_now : frame, std::move(payload) });
+	}
+
+	//appends the payloads of everything due this frame and moves on to the next
+	void advance(std::vector<T>& fired)
+	{
+		//coarsest first, so timers brought down a level can carry on down in the same frame
+		if ((m_now >> (SLOT_BITS * LEVELS) << (SLOT_BITS * LEVELS)) == m_now) cascade(m_overflow);
+		for (size_t level = LEVELS - 1; level > 0; level--)
+		{
+			size_t shift = SLOT_BITS * level;
+			if ((m_now & ((size_t(1) << shift) - 1)) == 0) cascade(m_wheels[level][(m_now >> shift) & (SLOTS - 1)]);
+		}
+
+		auto& slot = m_wheels[0][m_now & (SLOTS - 1)];
+		for (auto& t : slot) fired.push_back(std::move(t.payload));
+		slot.clear();
+		m_now++;
+	}
+
+	size_t now() const
+	{
+		return m_now;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include<array>
+#include<mutex>
+#include<utility>
+
+//hands frames from one producer thread to one consumer thread
+//the producer fills back() and publishes it without ever waiting on the consumer,
+//the consumer picks up the newest published frame and keeps it until it asks again
+template<typename T>
+class TripleBuffer
+{
+	std::array<T, 3> m_buffers;
+	size_t m_back = 0;
+	size_t m_middle = 1;
+	size_t m_front = 2;
+	bool m_fresh = false;	//middle holds a frame the consumer hasn't taken yet
+	std::mutex m_mutex;		//only held for an index swap
+
+public:
+
+	T& back()
+	{
+		return m_buffers[m_back];
+	}
+
+	void publish()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::swap(m_back, m_middle);
+		m_fresh = true;
+	}
+
+	//returns false and keeps the current front when nothing new was published
+	bool acquire()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_fresh) return false;
+		std::swap(m_front, m_middle);
+		m_fresh = false;
+		return true;
+	}
+
+	const T& front() const
+	{
+		return m_buffers[m_front];
+	}
+};
\ No newline at end of file
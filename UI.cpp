@@ -0,0 +1,143 @@
+#include "UI.h"
+
+bool UIElement::isDirty() const
+{
+	return m_dirty;
+}
+
+UIText::UIText(const sf::Font& font, unsigned characterSize, const std::string& string)
+	:m_string(string)
+{
+	m_text.setFont(font);
+	m_text.setCharacterSize(characterSize);
+	m_text.setString(string);
+	m_text.setFillColor(m_color);
+}
+
+void UIText::setString(const std::string& string)
+{
+	if (string == m_string) return;
+	m_string = string;
+	m_text.setString(string);
+	m_dirty = true;
+}
+
+void UIText::setFillColor(const sf::Color& color)
+{
+	if (color == m_color) return;
+	m_color = color;
+	m_text.setFillColor(color);
+	m_dirty = true;
+}
+
+void UIText::setPosition(float x, float y)
+{
+	if (m_position == sf::Vector2f(x, y)) return;
+	m_position = sf::Vector2f(x, y);
+	m_text.setPosition(m_position);
+	m_dirty = true;
+}
+
+sf::FloatRect UIText::getBounds() const
+{
+	return m_text.getGlobalBounds();
+}
+
+void UIText::draw(sf::RenderTarget& target)
+{
+	target.draw(m_text);
+	m_dirty = false;
+}
+
+//asking the font for each glyph rasterizes it into the font's page texture now rather than on first use
+UICounter::UICounter(const sf::Font& font, unsigned characterSize, int value)
+	:m_font(&font)
+	, m_characterSize(characterSize)
+	, m_vertices(sf::Quads)
+	, m_value(value)
+{
+	for (size_t i = 0; i < 10; i++) m_glyphs[i] = font.getGlyph('0' + (sf::Uint32)i, characterSize, false);
+	m_glyphs[10] = font.getGlyph('-', characterSize, false);
+	rebuild();
+}
+
+void UICounter::rebuild()
+{
+	std::string digits = std::to_string(m_value);
+	m_vertices.resize(digits.size() * 4);
+
+	//baseline sits one character size below the position, like sf::Text
+	float x = m_position.x;
+	float y = m_position.y + m_characterSize;
+	for (size_t i = 0; i < digits.size(); i++)
+	{
+		const sf::Glyph& g = m_glyphs[digits[i] == '-' ? 10 : digits[i] - '0'];
+		float left = x + g.bounds.left, top = y + g.bounds.top;
+		float right = left + g.bounds.width, bottom = top + g.bounds.height;
+		float u0 = (float)g.textureRect.left, v0 = (float)g.textureRect.top;
+		float u1 = u0 + g.textureRect.width, v1 = v0 + g.textureRect.height;
+
+		sf::Vertex* quad = &m_vertices[i * 4];
+		quad[0] = sf::Vertex(sf::Vector2f(left, top), m_color, sf::Vector2f(u0, v0));
+		quad[1] = sf::Vertex(sf::Vector2f(right, top), m_color, sf::Vector2f(u1, v0));
+		quad[2] = sf::Vertex(sf::Vector2f(right, bottom), m_color, sf::Vector2f(u1, v1));
+		quad[3] = sf::Vertex(sf::Vector2f(left, bottom), m_color, sf::Vector2f(u0, v1));
+		x += g.advance;
+	}
+	m_dirty = true;
+}
+
+void UICounter::setValue(int value)
+{
+	if (value == m_value) return;
+	m_value = value;
+	rebuild();
+}
+
+void UICounter::setFillColor(const sf::Color& color)
+{
+	if (color == m_color) return;
+	m_color = color;
+	rebuild();
+}
+
+void UICounter::setPosition(float x, float y)
+{
+	if (m_position == sf::Vector2f(x, y)) return;
+	m_position = sf::Vector2f(x, y);
+	rebuild();
+}
+
+void UICounter::draw(sf::RenderTarget& target)
+{
+	target.draw(m_vertices, sf::RenderStates(&m_font->getTexture(m_characterSize)));
+	m_dirty = false;
+}
+
+void UILayer::draw(RenderStats& renderer)
+{
+	auto& target = renderer.target();
+	if (m_size != target.getSize())
+	{
+		m_size = target.getSize();
+		m_cache.create(m_size.x, m_size.y);
+		m_sprite.setTexture(m_cache.getTexture(), true);
+		m_dirty = true;
+	}
+
+	for (auto& e : m_elements) m_dirty = m_dirty || e->isDirty();
+
+	if (m_dirty)
+	{
+		m_cache.clear(sf::Color::Transparent);
+		for (auto& e : m_elements) e->draw(m_cache);
+		m_cache.display();
+		m_dirty = false;
+	}
+
+	//the cache already holds blended colour, so it goes on premultiplied
+	sf::View view = target.getView();
+	target.setView(target.getDefaultView());
+	renderer.draw(m_sprite, sf::RenderStates(sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha)));
+	target.setView(view);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "RenderStats.h"
+
+#include<SFML/Graphics.hpp>
+#include<array>
+#include<memory>
+#include<string>
+#include<vector>
+
+//something drawn in screen space by a UILayer, marks itself dirty whenever what it shows changes
+class UIElement
+{
+protected:
+	bool m_dirty = true;
+
+public:
+	virtual ~UIElement() {}
+
+	virtual void draw(sf::RenderTarget& target) = 0;
+	bool isDirty() const;
+};
+
+//a line of text whose glyph geometry is only rebuilt when its content or style changes
+class UIText : public UIElement
+{
+	sf::Text m_text;
+	std::string m_string;
+	sf::Color m_color = sf::Color::White;
+	sf::Vector2f m_position;
+
+public:
+	UIText(const sf::Font& font, unsigned characterSize, const std::string& string = "");
+
+	void setString(const std::string& string);
+	void setFillColor(const sf::Color& color);
+	void setPosition(float x, float y);
+	sf::FloatRect getBounds() const;
+
+	void draw(sf::RenderTarget& target);
+};
+
+//a number drawn from a strip of digit glyphs baked into the font once,
+//changing the value only rewrites a handful of quads and never touches sf::Text
+class UICounter : public UIElement
+{
+	const sf::Font* m_font;
+	unsigned m_characterSize;
+	std::array<sf::Glyph, 11> m_glyphs;	//0-9 then the minus sign
+	sf::VertexArray m_vertices;
+	sf::Color m_color = sf::Color::White;
+	sf::Vector2f m_position;
+	int m_value = 0;
+
+	void rebuild();
+
+public:
+	UICounter(const sf::Font& font, unsigned characterSize, int value = 0);
+
+	void setValue(int value);
+	void setFillColor(const sf::Color& color);
+	void setPosition(float x, float y);
+
+	void draw(sf::RenderTarget& target);
+};
+
+//composites its elements into a cached texture that is only redrawn when one of them is dirty,
+//on frames where nothing changed drawing the whole layer is a single textured quad
+class UILayer
+{
+	std::vector<std::shared_ptr<UIElement>> m_elements;
+	sf::RenderTexture m_cache;
+	sf::Sprite m_sprite;
+	sf::Vector2u m_size;
+	bool m_dirty = true;
+
+public:
+
+	template<typename T, typename... TArgs>
+	std::shared_ptr<T> add(TArgs&&... args)
+	{
+		auto element = std::make_shared<T>(std::forward<TArgs>(args)...);
+		m_elements.push_back(element);
+		m_dirty = true;
+		return element;
+	}
+
+	void draw(RenderStats& renderer);
+};
\ No newline at end of file
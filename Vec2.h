@@ -1,5 +1,8 @@
 #pragma once
 
+#include<cmath>
+
+//header only so the operators inline into the systems that use them
 class Vec2
 {
 public:
@@ -7,24 +10,31 @@ public:
 	float x = 0;
 	float y = 0;
 
-	Vec2();
-	Vec2(float xin, float yin);
+	constexpr Vec2() {}
+	constexpr Vec2(float xin, float yin)
+		:x(xin), y(yin) {}
+
+	constexpr bool operator == (const Vec2& rhs) const { return x == rhs.x && y == rhs.y; }
+	constexpr bool operator != (const Vec2& rhs) const { return x != rhs.x || y != rhs.y; }
 
-	bool operator == (const Vec2& rhs) const;
-	bool operator != (const Vec2& rhs) const;
+	constexpr Vec2 operator + (const Vec2& rhs) const { return Vec2(x + rhs.x, y + rhs.y); }
+	constexpr Vec2 operator - (const Vec2& rhs) const { return Vec2(x - rhs.x, y - rhs.y); }
+	constexpr Vec2 operator * (const float val) const { return Vec2(x * val, y * val); }
+	constexpr Vec2 operator / (const float val) const { return Vec2(x / val, y / val); }
 
-	Vec2 operator + (const Vec2& rhs) const;
-	Vec2 operator - (const Vec2& rhs) const;
-	Vec2 operator * (const float val) const;
-	Vec2 operator / (const float val) const;
+	constexpr void operator += (const Vec2& rhs) { x += rhs.x; y += rhs.y; }
+	constexpr void operator -= (const Vec2& rhs) { x -= rhs.x; y -= rhs.y; }
+	constexpr void operator *= (const float val) { x *= val; y *= val; }
+	constexpr void operator /= (const float val) { x /= val; y /= val; }
 
-	void operator += (const Vec2& rhs);
-	void operator -= (const Vec2& rhs);
-	void operator *= (const float val);
-	void operator /= (const float val);
+	constexpr float lengthSquared() const { return x * x + y * y; }
 
-	float dist(const Vec2& rhs) const;
-	float length() const;
+	float dist(const Vec2& rhs) const { return (*this - rhs).length(); }
+	float length() const { return std::sqrt(lengthSquared()); }
 
-	Vec2 normalize() const;
+	Vec2 normalize() const
+	{
+		float l = length();
+		return Vec2(x / l, y / l);
+	}
 };
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "WorldPool.h"
+
+WorldPool::WorldPool(const Assets& assets, size_t threadCount)
+	:m_assets(assets)
+{
+	if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	for (size_t i = 0; i < threadCount; i++)
+	{
+		m_threads.emplace_back(&WorldPool::workerLoop, this);
+	}
+}
+
+WorldPool::~WorldPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wake.notify_all();
+	for (auto& t : m_threads) t.join();
+}
+
+size_t WorldPool::addWorld(const std::string& levelPath)
+{
+	m_worlds.push_back(std::make_shared<Scene_Play>(m_assets, levelPath));
+	return m_worlds.size() - 1;
+}
+
+void WorldPool::resetWorld(size_t index, const std::string& levelPath)
+{
+	m_worlds[index] = std::make_shared<Scene_Play>(m_assets, levelPath);
+}
+
+//worlds are handed out one at a time from a shared counter so a slow world doesn't hold up a whole slice
+void WorldPool::runJob()
+{
+	for (size_t i = m_next++; i < m_worlds.size(); i = m_next++)
+	{
+		(*m_job)(*m_worlds[i], i);
+	}
+}
+
+void WorldPool::workerLoop()
+{
+	size_t seen = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [&] { return m_stopping || m_generation != seen; });
+			if (m_stopping) return;
+			seen = m_generation;
+		}
+
+		runJob();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_working == 0) m_done.notify_one();
+	}
+}
+
+void WorldPool::forEach(const WorldJob& job)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_job = &job;
+	m_next = 0;
+	m_working = m_threads.size();
+	m_generation++;
+	m_wake.notify_all();
+	m_done.wait(lock, [&] { return m_working == 0; });
+	m_job = nullptr;
+}
+
+void WorldPool::step(size_t frames)
+{
+	forEach([frames](Scene_Play& world, size_t)
+	{
+		if (!world.hasEnded()) world.simulate(frames);
+	});
+}
+
+Scene_Play& WorldPool::world(size_t index)
+{
+	return *m_worlds[index];
+}
+
+size_t WorldPool::size() const
+{
+	return m_worlds.size();
+}
+
+size_t WorldPool::threadCount() const
+{
+	return m_threads.size();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Scene_Play.h"
+
+#include<atomic>
+#include<condition_variable>
+#include<functional>
+#include<mutex>
+#include<thread>
+
+//many independent headless Scene_Play worlds sharing one read-only Assets
+//worlds are stepped by a fixed set of worker threads, each world is only ever touched by one of them at a time
+class WorldPool
+{
+	typedef std::function<void(Scene_Play& world, size_t index)> WorldJob;
+
+	const Assets& m_assets;
+	std::vector<std::shared_ptr<Scene_Play>> m_worlds;
+	std::vector<std::thread> m_threads;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	const WorldJob* m_job = nullptr;
+	size_t m_generation = 0;	//bumped for every job so sleeping workers know there is new work
+	size_t m_working = 0;		//workers still busy with the current job
+	bool m_stopping = false;
+	std::atomic<size_t> m_next{ 0 };	//next world index to hand out
+
+	void workerLoop();
+	void runJob();
+
+public:
+
+	WorldPool(const Assets& assets, size_t threadCount = 0);
+	~WorldPool();
+
+	size_t addWorld(const std::string& levelPath);
+	void resetWorld(size_t index, const std::string& levelPath);
+
+	//runs job once for every world across the workers and returns when all are done
+	void forEach(const WorldJob& job);
+	void step(size_t frames);
+
+	Scene_Play& world(size_t index);
+	size_t size() const;
+	size_t threadCount() const;
+};
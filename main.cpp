@@ -1,6 +1,295 @@
 #include "GameEngine.h"
+#include "WorldPool.h"
+#include "Rollback.h"
+#include "LevelCompiler.h"
+#include "Benchmark.h"
+
+#include<numeric>
+#include<random>
+#include<thread>
+
+//headless balance run: plays one level in many worlds at once and reports how they ended
+static int runBatch(const std::string& levelPath, size_t worldCount, size_t frames)
+{
+	Assets assets;
+	assets.loadFromFile("bin/assets.txt");
+
+	WorldPool pool(assets);
+	for (size_t i = 0; i < worldCount; i++) pool.addWorld(levelPath);
+
+	sf::Clock clock;
+	pool.step(frames);
+	float seconds = clock.getElapsedTime().asSeconds();
+
+	size_t ended = 0;
+	for (size_t i = 0; i < pool.size(); i++) { if (pool.world(i).hasEnded()) ended++; }
+
+	std::cout << worldCount << " worlds x " << frames << " frames on " << pool.threadCount() << " threads in " << seconds << "s ("
+		<< (worldCount * frames) / std::max(seconds, 0.0001f) << " frames/s), " << ended << " ended\n";
+	return 0;
+}
+
+//offline level build: merges the plain ground tiles into big colliders and writes the result out
+static int compileLevel(const std::string& levelPath, const std::string& outputPath)
+{
+	Assets assets;
+	assets.loadFromFile("bin/assets.txt");
+
+	LevelCompiler::Stats stats;
+	auto entries = LevelCompiler::Read(levelPath);
+	auto manifest = LevelCompiler::Manifest(entries);
+	assets.acquire(manifest);
+	entries = LevelCompiler::Compile(entries, assets, Vec2(64, 64), stats);
+	if (!LevelCompiler::Write(outputPath, entries)) return 1;
+
+	LevelCompiler::PrintStats(levelPath, stats, std::cout);
+	return 0;
+}
+
+//frame time and gameplay regression check against a recorded baseline, only --bench-update writes one
+static int runBenchmark(const std::string& baselinePath, size_t frames, float tolerance, bool update)
+{
+	//a missing baseline fails the check up front rather than quietly recording a new one
+	if (!update && !std::ifstream(baselinePath))
+	{
+		std::cerr << "No benchmark baseline at " << baselinePath << ", record one with --bench-update\n";
+		return 1;
+	}
+
+	Assets assets;
+	assets.loadFromFile("bin/assets.txt");
+
+	auto results = Benchmark::Run(assets, frames);
+	if (update)
+	{
+		if (!Benchmark::WriteBaseline(baselinePath, results)) return 1;
+		std::cout << "wrote benchmark baseline " << baselinePath << "\n";
+		return 0;
+	}
+
+	bool passed = Benchmark::Compare(baselinePath, results, tolerance, std::cout);
+	std::cout << (passed ? "benchmark passed\n" : "benchmark FAILED\n");
+	return passed ? 0 : 1;
+}
+
+//draws a level into an offscreen texture and fails if any frame went over the draw call budget, for machines without a window
+static int runRenderBudget(const std::string& levelPath, size_t frames, size_t maxDrawCalls, const std::string& logPath)
+{
+	Assets assets;
+	assets.loadFromFile("bin/assets.txt");
+
+	Scene_Play scene(assets, levelPath);
+	sf::RenderTexture texture;
+	if (!texture.create((unsigned)scene.width(), (unsigned)scene.height()))
+	{
+		std::cerr << "Couldn't create offscreen render target\n";
+		return 1;
+	}
+
+	RenderStats stats(texture);
+	if (!logPath.empty() && !stats.openLog(logPath)) return 1;
+	scene.setRenderer(&stats);
+
+	//run right the whole way so the camera sweeps the level
+	Scene& world = scene;
+	world.doAction(Action("RIGHT", "START"));
+	for (size_t i = 0; i < frames && !world.hasEnded(); i++)
+	{
+		world.simulate(1);
+		world.sRender();
+	}
+
+	auto& worst = stats.worstFrame();
+	bool passed = worst.drawCalls <= maxDrawCalls;
+	std::cout << stats.frames() << " frames, worst " << worst.drawCalls << " draw calls (budget " << maxDrawCalls << "), "
+		<< worst.textureChanges << " texture changes, " << worst.vertices << " vertices\n";
+	std::cout << (passed ? "render budget passed\n" : "render budget FAILED\n");
+	return passed ? 0 : 1;
+}
+
+//records the same spawns and destroys from one thread per slot, started in a shuffled order and finishing at staggered times,
+//returns id and x of every entity that survived the merge in manager order
+static std::vector<std::pair<size_t, float>> spawnScrambled(size_t slots, size_t perSlot, unsigned seed)
+{
+	EntityManager manager;
+	manager.addEntity("Player");	//an id handed out before the parallel part
+	manager.prepareCommands(slots);
+
+	std::vector<size_t> order(slots);
+	std::iota(order.begin(), order.end(), 0);
+	if (seed) std::shuffle(order.begin(), order.end(), std::mt19937(seed));
+
+	std::vector<std::thread> workers;
+	for (size_t n = 0; n < slots; n++)
+	{
+		size_t slot = order[n];
+		workers.emplace_back([&manager, slot, perSlot, n]()
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(((n * 7919) % 13) * 50));
+			auto& commands = manager.commands(slot);
+			for (size_t i = 0; i < perSlot; i++)
+			{
+				auto e = commands.addEntity("Dec");
+				e->addComponent<CTransform>(Vec2((float)(slot * perSlot + i), 0.f));
+				if (i % 3 == 0) commands.destroy(e);
+			}
+		});
+	}
+	for (auto& w : workers) w.join();
+	manager.update();
+
+	std::vector<std::pair<size_t, float>> result;
+	for (auto& e : manager.getEntities()) result.push_back({ e->id(), e->getComponent<CTransform>().pos.x });
+	return result;
+}
+
+//the command buffer merge and a parallel level load must come out the same whatever the thread scheduling did
+static int runSpawnTest(const std::string& levelPath, size_t runs)
+{
+	auto reference = spawnScrambled(16, 500, 0);
+	for (unsigned seed = 1; seed <= runs; seed++)
+	{
+		if (spawnScrambled(16, 500, seed) != reference)
+		{
+			std::cout << "command buffer merge depends on scheduling (seed " << seed << ")\n";
+			return 1;
+		}
+	}
+
+	Assets assets;
+	assets.loadFromFile("bin/assets.txt");
+
+	uint64_t referenceHash = 0;
+	for (size_t run = 0; run < runs; run++)
+	{
+		Scene_Play world(assets, levelPath);
+		WorldState state;
+		world.captureState(state);
+		uint64_t hash = Snapshot::Hash(state);
+		if (run == 0) referenceHash = hash;
+		else if (hash != referenceHash)
+		{
+			std::cout << "level load " << run << " hashed " << std::hex << hash << " instead of " << referenceHash << std::dec << "\n";
+			return 1;
+		}
+	}
+
+	std::cout << "spawn test passed: " << runs << " scrambled merges and " << runs << " loads of " << levelPath << " identical\n";
+	return 0;
+}
+
+//scripted input so both peers can produce the other's "keyboard" without talking
+static uint8_t scriptedInput(size_t player, size_t frame)
+{
+	uint32_t x = (uint32_t)(frame / 12) * 2654435761u ^ (uint32_t)(player + 1) * 40503u;
+	x ^= x >> 13;
+	x *= 0x5bd1e995;
+	x ^= x >> 15;
+	return (uint8_t)(x & 0x0f);
+}
+
+//two headless peers over 127.0.0.1 with injected latency and loss, they must end on the same state
+static int runNetplayTest(const std::string& levelPath, size_t frames, size_t latency, float loss)
+{
+	Assets assets;
+	assets.loadFromFile("bin/assets.txt");
+
+	Scene_Play a(assets, levelPath, 2), b(assets, levelPath, 2);
+	a.startNetplay(0, 47001, "127.0.0.1", 47002);
+	b.startNetplay(1, 47002, "127.0.0.1", 47001);
+	a.session()->setSimulatedLatency(latency);
+	b.session()->setSimulatedLatency(latency);
+	a.session()->setPacketLoss(loss, 1);
+	b.session()->setPacketLoss(loss, 2);
+
+	auto& sa = *a.session();
+	auto& sb = *b.session();
+	sf::Clock timeout;
+	while (sa.frame() < frames || sb.frame() < frames || !sa.synchronized() || !sb.synchronized())
+	{
+		if (sa.frame() < frames) sa.advance(scriptedInput(0, sa.frame()));
+		else sa.poll();
+		if (sb.frame() < frames) sb.advance(scriptedInput(1, sb.frame()));
+		else sb.poll();
+
+		if (timeout.getElapsedTime().asSeconds() > 30.f)
+		{
+			std::cerr << "netplay test timed out\n";
+			return 1;
+		}
+	}
+
+	WorldState stateA, stateB;
+	a.captureState(stateA);
+	b.captureState(stateB);
+	uint64_t hashA = Snapshot::Hash(stateA), hashB = Snapshot::Hash(stateB);
+
+	sa.printStats(std::cout);
+	sb.printStats(std::cout);
+	std::cout << "final state " << std::hex << hashA << " / " << hashB << std::dec << (hashA == hashB ? " match\n" : " MISMATCH\n");
+
+	//a full MAX_ROLLBACK resimulation has to fit in one frame or the game visibly hitches when it happens
+	const float budgetMicros = 16000.f;
+	float worst = std::max(sa.maxRollbackMicros(), sb.maxRollbackMicros());
+	bool inBudget = worst <= budgetMicros;
+	std::cout << "worst rollback " << worst << " us, budget " << budgetMicros << " us" << (inBudget ? "\n" : " OVER BUDGET\n");
+	return (hashA == hashB && inBudget) ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+	if (argc == 5 && std::string(argv[1]) == "--batch")
+	{
+		return runBatch(argv[2], std::stoul(argv[3]), std::stoul(argv[4]));
+	}
+
+	if (argc == 4 && std::string(argv[1]) == "--compile-level")
+	{
+		return compileLevel(argv[2], argv[3]);
+	}
+
+	//--bench <baseline> <frames> <tolerance, 0.1 = 10% slower>   --bench-update <baseline> <frames>
+	if (argc == 5 && std::string(argv[1]) == "--bench")
+	{
+		return runBenchmark(argv[2], std::stoul(argv[3]), std::stof(argv[4]), false);
+	}
+
+	if (argc == 4 && std::string(argv[1]) == "--bench-update")
+	{
+		return runBenchmark(argv[2], std::stoul(argv[3]), 0, true);
+	}
+
+	//--render-budget <level> <frames> <max draw calls> [csv]
+	if ((argc == 5 || argc == 6) && std::string(argv[1]) == "--render-budget")
+	{
+		return runRenderBudget(argv[2], std::stoul(argv[3]), std::stoul(argv[4]), argc == 6 ? argv[5] : "");
+	}
+
+	//--spawn-test <level> <runs>
+	if (argc == 4 && std::string(argv[1]) == "--spawn-test")
+	{
+		return runSpawnTest(argv[2], std::stoul(argv[3]));
+	}
+
+	if (argc == 6 && std::string(argv[1]) == "--netplay-test")
+	{
+		return runNetplayTest(argv[2], std::stoul(argv[3]), std::stoul(argv[4]), std::stof(argv[5]));
+	}
 
-int main() {
 	GameEngine g("bin/assets.txt");
+
+	//--render-log <csv>: draw calls, texture changes and vertices of every frame
+	if (argc == 3 && std::string(argv[1]) == "--render-log")
+	{
+		if (!g.renderStats().openLog(argv[2])) return 1;
+	}
+
+	//--netplay <level> <player 0|1> <local port> <remote host> <remote port>
+	if (argc == 7 && std::string(argv[1]) == "--netplay")
+	{
+		auto scene = std::make_shared<Scene_Play>(&g, argv[2], 2);
+		scene->startNetplay(std::stoul(argv[3]), (unsigned short)std::stoul(argv[4]), argv[5], (unsigned short)std::stoul(argv[6]));
+		g.changeScene("PLAY", scene);
+	}
+
 	g.run();
-}
\ No newline at end of file
+}